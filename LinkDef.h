@@ -6,5 +6,11 @@
 
 #pragma link C++ class TJSONFile;
 #pragma link C++ class TKeyJSON;
+#pragma link C++ class TJSONTreeReader-;
+#pragma link C++ class TJSONCodec-;
+#pragma link C++ class TJSONBufferWriter-;
+#pragma link C++ class TJSONBufferMerger-;
+#pragma link C++ class TJSONFileMerger-;
+#pragma link C++ class TJSONConverter-;
 
 #endif
@@ -0,0 +1,251 @@
+// Author: agent  16.10.2026
+
+/*************************************************************************
+ * Copyright (C) 1995-2026, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//________________________________________________________________________
+//
+// TJSONBufferMerger allows to write objects into TJSONFile from many threads.
+//
+// Every producer thread gets its own TJSONBufferWriter. Writer converts
+// objects to JSON directly in the producer thread and collects produced
+// records in local buffer. When buffer exceeds flush size (or with
+// explicit Flush() call), records are handed over to the merger queue.
+// Only queue operations are protected by mutex, therefore producers
+// never wait for the file I/O.
+//
+// Separate sink thread takes records from the queue and creates keys in
+// the file - assigns key ids and cycles, applies deduplication and delta
+// cycles, spills records when spill limit is configured. Records of single
+// writer are appended in the order of writing; records of different
+// writers are interleaved in the order of flushing.
+//
+//   ROOT::EnableThreadSafety();
+//   TJSONFile f("out.json", "recreate");
+//   {
+//      TJSONBufferMerger merger(&f);
+//      auto work = [&merger](int n) {
+//         auto writer = merger.GetWriter();
+//         TH1F h(Form("h%d", n), "histogram", 100, -5, 5);
+//         h.FillRandom("gaus");
+//         writer->WriteTObject(&h);
+//      };
+//      std::vector<std::thread> threads;
+//      for (int n = 0; n < 8; n++)
+//         threads.emplace_back(work, n);
+//      for (auto &t : threads)
+//         t.join();
+//   }
+//   f.Close();
+//
+// While merger exists, file itself should not be modified from other threads.
+// Destructor of merger waits until all queued records are written.
+//________________________________________________________________________
+
+#include "TJSONBufferMerger.h"
+
+#include "TJSONFile.h"
+#include "TJSONCodec.h"
+#include "TBufferJSON.h"
+#include "TClass.h"
+#include "TObject.h"
+#include "TTree.h"
+#include "TError.h"
+
+#include <nlohmann/json.hpp>
+
+////////////////////////////////////////////////////////////////////////////////
+/// Destructor, hands over all buffered records to the merger
+
+TJSONBufferWriter::~TJSONBufferWriter()
+{
+   Flush();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Convert TObject to JSON and buffer it for writing into the file
+
+Bool_t TJSONBufferWriter::WriteTObject(const TObject *obj, const char *name, const char *title)
+{
+   if (!obj)
+      return kFALSE;
+
+   TClass *actual = obj->IsA();
+   const void *ptr = (const void *)((Longptr_t)obj - actual->GetBaseClassOffset(TObject::Class()));
+
+   return WriteObjectAny(ptr, actual, name && *name ? name : obj->GetName(), title);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Convert object to JSON and buffer it for writing into the file
+/// Conversion is performed in the calling thread
+/// Returns kFALSE if merger was created without writable file, object is not stored then
+
+Bool_t TJSONBufferWriter::WriteObjectAny(const void *obj, const TClass *cl, const char *name, const char *title)
+{
+   if (!fMerger || !fMerger->fFile)
+      return kFALSE;
+
+   Record rec;
+   if (!MakeRecord(rec, obj, cl, name, title))
+      return kFALSE;
+
+   fBufferSize += rec.fSize;
+   fRecords.emplace_back(std::move(rec));
+
+   if (fBufferSize >= fMerger->GetFlushSize())
+      Flush();
+
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Convert object to JSON record, which can be stored with TJSONFile::CreateKey()
+/// Object is converted with TJSONCodec if available, otherwise with TBufferJSON
+
+Bool_t TJSONBufferWriter::MakeRecord(Record &rec, const void *obj, const TClass *cl, const char *name, const char *title)
+{
+   if (!obj || !cl)
+      return kFALSE;
+
+   if (cl->InheritsFrom(TTree::Class())) {
+      ::Error("TJSONBufferWriter::MakeRecord", "TTree %s cannot be converted to JSON record", name);
+      return kFALSE;
+   }
+
+   rec.fName = name && *name ? name : cl->GetName();
+   rec.fTitle = title ? title : "";
+   rec.fClassName = cl->GetName();
+   rec.fPayload.clear();
+   rec.fObject.reset();
+
+   auto codec = TJSONCodec::Find(cl);
+   if (!codec || !codec->Write(rec.fPayload, obj)) {
+      rec.fPayload.clear();
+      auto json_str = TBufferJSON::ConvertToJSON(obj, cl);
+      if (json_str.Length() == 0)
+         return kFALSE;
+      rec.fSize = json_str.Length();
+      rec.fObject = std::make_shared<nlohmann::json>(nlohmann::json::parse(json_str.Data()));
+   } else {
+      rec.fSize = rec.fPayload.length();
+   }
+
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Hand over all buffered records to the merger
+
+void TJSONBufferWriter::Flush()
+{
+   if (fRecords.empty() || !fMerger)
+      return;
+
+   fMerger->Push(std::move(fRecords));
+   fRecords.clear();
+   fBufferSize = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Constructor, starts sink thread which writes records into the file
+/// File must be opened for writing and should exist longer than merger
+
+TJSONBufferMerger::TJSONBufferMerger(TJSONFile *file) : fFile(file)
+{
+   if (!fFile || !fFile->IsWritable()) {
+      ::Error("TJSONBufferMerger", "File is not provided or not writable");
+      fFile = nullptr;
+      return;
+   }
+
+   fSink = std::thread(&TJSONBufferMerger::SinkLoop, this);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Destructor, writes all queued records and stops sink thread
+/// Writers should be destroyed before merger
+
+TJSONBufferMerger::~TJSONBufferMerger()
+{
+   {
+      std::lock_guard<std::mutex> lock(fMutex);
+      fStop = kTRUE;
+   }
+   fCond.notify_all();
+
+   if (fSink.joinable())
+      fSink.join();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns new writer, which should be used only by single thread
+
+std::unique_ptr<TJSONBufferWriter> TJSONBufferMerger::GetWriter()
+{
+   return std::unique_ptr<TJSONBufferWriter>(new TJSONBufferWriter(this));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Add records to the queue, called by writers
+
+void TJSONBufferMerger::Push(std::vector<TJSONBufferWriter::Record> &&records)
+{
+   if (!fFile)
+      return;
+
+   {
+      std::lock_guard<std::mutex> lock(fMutex);
+      fQueue.emplace_back(std::move(records));
+   }
+   fCond.notify_all();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Wait until all queued records are written into the file
+/// Records, which are still buffered in writers, are not considered
+
+void TJSONBufferMerger::Wait()
+{
+   std::unique_lock<std::mutex> lock(fMutex);
+   fCond.wait(lock, [this] { return fQueue.empty() && !fBusy; });
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Loop of sink thread, creates keys for all queued records
+
+void TJSONBufferMerger::SinkLoop()
+{
+   std::unique_lock<std::mutex> lock(fMutex);
+
+   while (true) {
+      fCond.wait(lock, [this] { return fStop || !fQueue.empty(); });
+
+      if (fQueue.empty()) {
+         if (fStop)
+            break;
+         continue;
+      }
+
+      auto records = std::move(fQueue.front());
+      fQueue.pop_front();
+      fBusy = kTRUE;
+
+      lock.unlock();
+
+      for (auto &rec : records)
+         fFile->CreateKey(fFile, rec.fName.c_str(), rec.fTitle.c_str(), rec.fClassName.c_str(), rec.fPayload,
+                          rec.fObject.get(), rec.fSize);
+
+      records.clear();
+
+      lock.lock();
+      fBusy = kFALSE;
+      fCond.notify_all();
+   }
+}
@@ -0,0 +1,96 @@
+// Author: agent  16.10.2026
+
+/*************************************************************************
+ * Copyright (C) 1995-2026, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TJSONBufferMerger
+#define ROOT_TJSONBufferMerger
+
+#include "RtypesCore.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TClass;
+class TObject;
+class TJSONFile;
+class TJSONBufferMerger;
+
+class TJSONBufferWriter {
+
+   friend class TJSONBufferMerger;
+
+public:
+   struct Record {
+      std::string fName;      ///< key name
+      std::string fTitle;     ///< key title
+      std::string fClassName; ///< class of object
+      std::string fPayload;   ///< JSON of object produced by TJSONCodec
+      std::shared_ptr<void> fObject; ///< parsed JSON of object when codec not used
+      Long64_t fSize{0};      ///< length of object JSON
+   };
+
+private:
+   TJSONBufferWriter(const TJSONBufferWriter &) = delete;            // TJSONBufferWriter cannot be copied
+   TJSONBufferWriter &operator=(const TJSONBufferWriter &) = delete; // TJSONBufferWriter cannot be copied
+
+   TJSONBufferMerger *fMerger{nullptr}; //! merger, which receives records
+   std::vector<Record> fRecords;        //! records, not yet passed to merger
+   Long64_t fBufferSize{0};             //! size of JSON in buffered records
+
+   TJSONBufferWriter(TJSONBufferMerger *merger) : fMerger(merger) {}
+
+public:
+   ~TJSONBufferWriter();
+
+   Bool_t WriteTObject(const TObject *obj, const char *name = nullptr, const char *title = nullptr);
+   Bool_t WriteObjectAny(const void *obj, const TClass *cl, const char *name, const char *title = nullptr);
+
+   void Flush();
+
+   static Bool_t MakeRecord(Record &rec, const void *obj, const TClass *cl, const char *name, const char *title = nullptr);
+};
+
+class TJSONBufferMerger {
+
+   friend class TJSONBufferWriter;
+
+private:
+   TJSONBufferMerger(const TJSONBufferMerger &) = delete;            // TJSONBufferMerger cannot be copied
+   TJSONBufferMerger &operator=(const TJSONBufferMerger &) = delete; // TJSONBufferMerger cannot be copied
+
+   TJSONFile *fFile{nullptr};                                   //! output file, not owned
+   Long64_t fFlushSize{1000000};                                //! size of buffer in writer, which triggers flush
+   std::mutex fMutex;                                           //! protects queue
+   std::condition_variable fCond;                               //! signals new records or empty queue
+   std::deque<std::vector<TJSONBufferWriter::Record>> fQueue;   //! records, waiting for writing into file
+   Bool_t fBusy{kFALSE};                                        //! sink writes records into file
+   Bool_t fStop{kFALSE};                                        //! sink thread should finish
+   std::thread fSink;                                           //! thread, writing records into file
+
+   void Push(std::vector<TJSONBufferWriter::Record> &&records);
+   void SinkLoop();
+
+public:
+   TJSONBufferMerger(TJSONFile *file);
+   ~TJSONBufferMerger();
+
+   std::unique_ptr<TJSONBufferWriter> GetWriter();
+
+   void SetFlushSize(Long64_t size) { fFlushSize = size; }
+   Long64_t GetFlushSize() const { return fFlushSize; }
+
+   void Wait();
+};
+
+#endif
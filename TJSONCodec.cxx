@@ -0,0 +1,884 @@
+// Author: agent  16.10.2026
+
+/*************************************************************************
+ * Copyright (C) 1995-2026, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//________________________________________________________________________
+//
+// TJSONCodec is registry of specialized serializers, used by TKeyJSON
+// instead of generic TBufferJSON for the classes with exact match.
+// Codec produces the same JSON as TBufferJSON::ConvertToJSON() does, so
+// written data remain readable by generic code and by JSROOT.
+//
+// Built-in codecs handle TH1F, TH1D, TH1I, TH2F, TH2D, TH3F, TH3D and
+// TProfile. Axes, statistics and bins arrays are written in single pass
+// directly into output string and read back from the text without
+// building JSON DOM. Histograms with functions, labels or not-flushed
+// buffer are left to generic code.
+// Mostly empty bins arrays are written in sparse "$arr" format of
+// TBufferJSON, where only runs of non-zero values are stored. Format is
+// chosen per array, when it produces smaller text.
+// With WriteStream() JSON is produced in chunks of limited size, which
+// are passed to the caller while bins arrays are written. This allows
+// to store histograms with huge number of bins with constant extra memory.
+// ReadStream() does the same for reading - bins arrays are decoded by
+// TJSONPullParser directly into the histogram.
+//
+// Custom codecs can be registered with TJSONCodec::Register() before
+// files are used.
+//________________________________________________________________________
+
+#include "TJSONCodec.h"
+
+#include "TJSONTape.h"
+#include "TJSONPullParser.h"
+#include "TClass.h"
+#include "TList.h"
+#include "THashList.h"
+#include "TAxis.h"
+#include "TH1.h"
+#include "TH2.h"
+#include "TH3.h"
+#include "TProfile.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+/// Access to protected members of histogram classes, which have no plain setters or getters
+
+struct TAttAxisAccess : public TAttAxis {
+   static constexpr Int_t TAttAxis::*Ndivisions = &TAttAxisAccess::fNdivisions;
+};
+
+struct TAxisAccess : public TAxis {
+   static constexpr Int_t TAxis::*First = &TAxisAccess::fFirst;
+   static constexpr Int_t TAxis::*Last = &TAxisAccess::fLast;
+   static constexpr UShort_t TAxis::*Bits2 = &TAxisAccess::fBits2;
+   static constexpr Bool_t TAxis::*TimeDisplay = &TAxisAccess::fTimeDisplay;
+   static constexpr TString TAxis::*TimeFormat = &TAxisAccess::fTimeFormat;
+   static constexpr Double_t TAxis::*Xmin = &TAxisAccess::fXmin;
+   static constexpr Double_t TAxis::*Xmax = &TAxisAccess::fXmax;
+};
+
+struct TH1Access : public TH1 {
+   static constexpr Int_t TH1::*Ncells = &TH1Access::fNcells;
+   static constexpr Short_t TH1::*BarOffset = &TH1Access::fBarOffset;
+   static constexpr Short_t TH1::*BarWidth = &TH1Access::fBarWidth;
+   static constexpr Double_t TH1::*Entries = &TH1Access::fEntries;
+   static constexpr Double_t TH1::*Tsumw = &TH1Access::fTsumw;
+   static constexpr Double_t TH1::*Tsumw2 = &TH1Access::fTsumw2;
+   static constexpr Double_t TH1::*Tsumwx = &TH1Access::fTsumwx;
+   static constexpr Double_t TH1::*Tsumwx2 = &TH1Access::fTsumwx2;
+   static constexpr Double_t TH1::*Maximum = &TH1Access::fMaximum;
+   static constexpr Double_t TH1::*Minimum = &TH1Access::fMinimum;
+   static constexpr Double_t TH1::*NormFactor = &TH1Access::fNormFactor;
+   static constexpr TArrayD TH1::*Contour = &TH1Access::fContour;
+   static constexpr TArrayD TH1::*Sumw2 = &TH1Access::fSumw2;
+   static constexpr TString TH1::*Option = &TH1Access::fOption;
+   static constexpr Int_t TH1::*BufferSize = &TH1Access::fBufferSize;
+   static constexpr Double_t *TH1::*Buffer = &TH1Access::fBuffer;
+   static constexpr EBinErrorOpt TH1::*BinStatErrOpt = &TH1Access::fBinStatErrOpt;
+   static constexpr EStatOverflows TH1::*StatOverflows = &TH1Access::fStatOverflows;
+};
+
+struct TH2Access : public TH2 {
+   static constexpr Double_t TH2::*Scalefactor = &TH2Access::fScalefactor;
+   static constexpr Double_t TH2::*Tsumwy = &TH2Access::fTsumwy;
+   static constexpr Double_t TH2::*Tsumwy2 = &TH2Access::fTsumwy2;
+   static constexpr Double_t TH2::*Tsumwxy = &TH2Access::fTsumwxy;
+};
+
+struct TH3Access : public TH3 {
+   static constexpr Double_t TH3::*Tsumwy = &TH3Access::fTsumwy;
+   static constexpr Double_t TH3::*Tsumwy2 = &TH3Access::fTsumwy2;
+   static constexpr Double_t TH3::*Tsumwxy = &TH3Access::fTsumwxy;
+   static constexpr Double_t TH3::*Tsumwz = &TH3Access::fTsumwz;
+   static constexpr Double_t TH3::*Tsumwz2 = &TH3Access::fTsumwz2;
+   static constexpr Double_t TH3::*Tsumwxz = &TH3Access::fTsumwxz;
+   static constexpr Double_t TH3::*Tsumwyz = &TH3Access::fTsumwyz;
+};
+
+struct TProfileAccess : public TProfile {
+   static constexpr TArrayD TProfile::*BinEntries = &TProfileAccess::fBinEntries;
+   static constexpr EErrorType TProfile::*ErrorMode = &TProfileAccess::fErrorMode;
+   static constexpr Double_t TProfile::*Ymin = &TProfileAccess::fYmin;
+   static constexpr Double_t TProfile::*Ymax = &TProfileAccess::fYmax;
+   static constexpr Bool_t TProfile::*Scaling = &TProfileAccess::fScaling;
+   static constexpr Double_t TProfile::*Tsumwy = &TProfileAccess::fTsumwy;
+   static constexpr Double_t TProfile::*Tsumwy2 = &TProfileAccess::fTsumwy2;
+   static constexpr TArrayD TProfile::*BinSumw2 = &TProfileAccess::fBinSumw2;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Produces JSON text directly in the output string
+/// When sink is provided, output is passed to the sink every time it exceeds chunk size,
+/// therefore arbitrary large arrays are written with bounded memory
+/// Non-finite numbers cannot be represented in JSON, writer marked as invalid
+
+class TJSONWriter {
+   std::string &fOut;   ///< output string
+   Bool_t fValid{kTRUE}; ///< false if value cannot be stored
+   std::size_t fChunk{std::string::npos};           ///< output size which triggers flushing
+   const TJSONCodec::Sink_t *fSink{nullptr};        ///< receiver of output pieces
+
+   /// Pass output to the sink when chunk size is exceeded
+   void Check()
+   {
+      if (fOut.length() >= fChunk)
+         Flush();
+   }
+
+public:
+   TJSONWriter(std::string &out) : fOut(out) {}
+
+   TJSONWriter(std::string &out, std::size_t chunk, const TJSONCodec::Sink_t &sink) : fOut(out), fChunk(chunk), fSink(&sink) {}
+
+   Bool_t IsValid() const { return fValid; }
+
+   /// Pass all produced output to the sink
+   /// After failure nothing more is passed, output is only discarded
+   void Flush()
+   {
+      if (!fSink)
+         return;
+      if (fValid && !fOut.empty() && !(*fSink)(fOut.data(), fOut.length()))
+         fValid = kFALSE;
+      fOut.clear();
+   }
+
+   void Begin(const char *typname)
+   {
+      fOut.append("{\"_typename\":");
+      String(typname);
+   }
+
+   void End() { fOut.push_back('}'); }
+
+   TJSONWriter &Member(const char *name)
+   {
+      Check();
+      fOut.append(",\"");
+      fOut.append(name);
+      fOut.append("\":");
+      return *this;
+   }
+
+   void Null() { fOut.append("null"); }
+
+   void Bool(Bool_t value) { fOut.append(value ? "true" : "false"); }
+
+   template <typename T>
+   void Number(T value)
+   {
+      if constexpr (std::is_floating_point<T>::value) {
+         if (!std::isfinite(value)) {
+            fValid = kFALSE;
+            value = 0;
+         }
+      }
+      char buf[64];
+      auto res = std::to_chars(buf, buf + sizeof(buf), value);
+      fOut.append(buf, res.ptr - buf);
+   }
+
+   template <typename T>
+   void Array(const T *arr, Int_t len)
+   {
+      fOut.push_back('[');
+      for (Int_t n = 0; n < len; n++) {
+         if (n > 0)
+            fOut.push_back(',');
+         Number(arr[n]);
+         Check();
+      }
+      fOut.push_back(']');
+   }
+
+   /// Find next run of non-zero values, starting from pos
+   /// Zeros gaps shorter than minimal gap are included into the run
+   template <typename T>
+   static Bool_t NextRun(const T *arr, Int_t len, Int_t &pos, Int_t &first, Int_t &last)
+   {
+      // zeros gap which is cheaper to skip than to write
+      const Int_t kMinGap = 8;
+
+      while ((pos < len) && (arr[pos] == 0))
+         pos++;
+      if (pos >= len)
+         return kFALSE;
+
+      first = pos;
+      last = pos + 1;
+      Int_t gap = 0;
+      for (pos = last; (pos < len) && (gap < kMinGap); pos++) {
+         if (arr[pos] == 0) {
+            gap++;
+         } else {
+            gap = 0;
+            last = pos + 1;
+         }
+      }
+      pos = last;
+      return kTRUE;
+   }
+
+   /// Write histogram bins array, sparse TBufferJSON "$arr" format is used when it is smaller
+   /// Runs of non-zero values are stored with their position, zeros between runs are skipped
+   /// Runs are identified twice - when counted and when written, so no extra memory is used
+   template <typename T>
+   void BinsArray(const T *arr, Int_t len)
+   {
+      Long64_t nruns = 0, skipped = len;
+      Int_t pos = 0, first = 0, last = 0;
+      while (NextRun(arr, len, pos, first, last)) {
+         nruns++;
+         skipped -= last - first;
+      }
+
+      // every skipped zero saves two characters, every run costs about 20 characters
+      if (skipped * 2 <= 40 + nruns * 20) {
+         Array(arr, len);
+         return;
+      }
+
+      fOut.append("{\"$arr\":");
+      String(std::is_same<T, Float_t>::value ? "Float32" : (std::is_same<T, Double_t>::value ? "Float64" : "Int32"));
+      fOut.append(",\"len\":");
+      Number(len);
+      pos = 0;
+      for (Long64_t n = 0; NextRun(arr, len, pos, first, last); n++) {
+         std::string suffix = n > 0 ? std::to_string(n) : std::string();
+         fOut.append(",\"p");
+         fOut.append(suffix);
+         fOut.append("\":");
+         Number(first);
+         fOut.append(",\"v");
+         fOut.append(suffix);
+         fOut.append("\":");
+         Array(arr + first, last - first);
+      }
+      fOut.push_back('}');
+   }
+
+   void String(const char *str)
+   {
+      static const char *hex = "0123456789abcdef";
+      fOut.push_back('"');
+      for (const char *c = str ? str : ""; *c; c++) {
+         switch (*c) {
+         case '"': fOut.append("\\\""); break;
+         case '\\': fOut.append("\\\\"); break;
+         case '\n': fOut.append("\\n"); break;
+         case '\t': fOut.append("\\t"); break;
+         case '\r': fOut.append("\\r"); break;
+         case '\b': fOut.append("\\b"); break;
+         case '\f': fOut.append("\\f"); break;
+         default:
+            if ((unsigned char)*c < 0x20) {
+               fOut.append("\\u00");
+               fOut.push_back(hex[(*c >> 4) & 0xf]);
+               fOut.push_back(hex[*c & 0xf]);
+            } else {
+               fOut.push_back(*c);
+            }
+         }
+      }
+      fOut.push_back('"');
+   }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reads members of JSON object, navigated with TJSONTape
+/// Any missing or mistyped member marks reader as invalid
+
+class TJSONReader {
+   TJSONTape::Value fNode;            ///< object node
+   Bool_t *fValid;                    ///< shared validity flag
+   TJSONPullParser *fPull{nullptr};   ///< parser for members, which are not included into skeleton
+
+public:
+   TJSONReader(TJSONTape::Value node, Bool_t *valid, TJSONPullParser *pull = nullptr)
+      : fNode(node), fValid(valid), fPull(pull)
+   {
+      if (!fNode.IsObject())
+         *fValid = kFALSE;
+   }
+
+   Bool_t IsValid() const { return *fValid; }
+
+   TJSONTape::Value Get(const char *name, TJSONTape::EType type)
+   {
+      auto value = fNode[name];
+      if (value.GetType() != type)
+         *fValid = kFALSE;
+      return value;
+   }
+
+   TJSONReader Sub(const char *name) { return TJSONReader(Get(name, TJSONTape::kObject), fValid); }
+
+   Bool_t IsNull(const char *name) { return fNode[name].IsNull(); }
+
+   Double_t Real(const char *name) { return Get(name, TJSONTape::kNumber).GetDouble(); }
+   Long64_t Int(const char *name) { return Get(name, TJSONTape::kNumber).GetLong(); }
+   Bool_t Bool(const char *name) { return Get(name, TJSONTape::kBool).GetBool(); }
+   std::string String(const char *name) { return Get(name, TJSONTape::kString).GetString(); }
+
+   /// Parse numbers from array text directly into destination, returns number of parsed values
+   /// or -1 if text is not an array or has more than maxlen values
+   template <typename T>
+   static Int_t ParseArray(std::string_view raw, T *dst, Int_t maxlen)
+   {
+      if ((raw.length() < 2) || (raw.front() != '[') || (raw.back() != ']'))
+         return -1;
+
+      const char *ptr = raw.data() + 1, *end = raw.data() + raw.length() - 1;
+      Int_t cnt = 0;
+      while (ptr < end) {
+         while ((ptr < end) && strchr(" ,\t\r\n", *ptr))
+            ptr++;
+         if (ptr >= end)
+            break;
+         if (cnt >= maxlen)
+            return -1;
+         char *next = nullptr;
+         if constexpr (std::is_same<T, Float_t>::value)
+            dst[cnt++] = std::strtof(ptr, &next);
+         else
+            dst[cnt++] = (T)std::strtod(ptr, &next);
+         if (next == ptr)
+            return -1;
+         ptr = next;
+      }
+
+      return cnt;
+   }
+
+   /// Position of member value, which should be read with pull parser, -1 if member is in skeleton
+   Long64_t Deferred(const char *name) const { return fPull ? fPull->GetDeferred(name) : -1; }
+
+   /// Returns number of array elements, counted without parsing of the values
+   /// Sparse array provides length explicitly
+   Int_t Length(const char *name)
+   {
+      Long64_t source = Deferred(name);
+      if (source >= 0) {
+         Long64_t len = fPull->ArrayLength(source);
+         if (len < 0)
+            *fValid = kFALSE;
+         return len;
+      }
+
+      auto node = fNode[name];
+      if (node.IsObject() && node["$arr"].IsValid())
+         return node["len"].GetLong();
+
+      auto raw = Get(name, TJSONTape::kArray).GetRaw();
+      if (raw.length() < 2)
+         return 0;
+      raw = raw.substr(1, raw.length() - 2);
+      if (raw.find_first_not_of(" \t\r\n") == std::string_view::npos)
+         return 0;
+      return std::count(raw.begin(), raw.end(), ',') + 1;
+   }
+
+   /// Read array with exactly len elements directly into destination
+   /// Dense JSON array or sparse TBufferJSON "$arr" object are supported
+   template <typename T>
+   void Array(const char *name, T *dst, Int_t len)
+   {
+      Long64_t source = Deferred(name);
+      if (source >= 0) {
+         if (!fPull->ReadArray(source, dst, len))
+            *fValid = kFALSE;
+         return;
+      }
+
+      auto node = fNode[name];
+
+      if (node.IsArray()) {
+         if (ParseArray(node.GetRaw(), dst, len) != len)
+            *fValid = kFALSE;
+         return;
+      }
+
+      if (!node.IsObject() || !node["$arr"].IsValid() || (node["len"].GetLong() != len)) {
+         *fValid = kFALSE;
+         return;
+      }
+
+      // sparse array: {"$arr":"Float64","len":N,"p":pos,"v":[...],"p1":pos1,"v1":value,"n1":cnt,...}
+      // only non-default values are stored, all other elements are 0
+      std::fill(dst, dst + len, 0);
+
+      Int_t pos = 0, size = node.GetSize();
+      for (Int_t n = 0; n < size; n++) {
+         auto item = node.At(n);
+         auto itemname = item.GetName();
+         if (itemname.empty() || (itemname == "$arr") || (itemname == "len"))
+            continue;
+         if (itemname[0] == 'p') {
+            pos = item.GetLong();
+         } else if (itemname[0] == 'v') {
+            if ((pos < 0) || (pos > len)) {
+               *fValid = kFALSE;
+               return;
+            }
+            if (item.IsArray()) {
+               Int_t cnt = ParseArray(item.GetRaw(), dst + pos, len - pos);
+               if (cnt < 0) {
+                  *fValid = kFALSE;
+                  return;
+               }
+               pos += cnt;
+            } else {
+               // single value, optionally repeated "n" times
+               auto next = (n + 1 < size) ? node.At(n + 1) : TJSONTape::Value();
+               Long64_t cnt = (next.GetName().length() > 0) && (next.GetName()[0] == 'n') ? next.GetLong() : 1;
+               T value = item.GetType() == TJSONTape::kBool ? (T)item.GetBool() : (T)item.GetDouble();
+               if ((cnt < 1) || (pos + cnt > len)) {
+                  *fValid = kFALSE;
+                  return;
+               }
+               std::fill(dst + pos, dst + pos + cnt, value);
+               pos += cnt;
+            }
+         }
+      }
+   }
+
+   /// Read array of unknown length
+   void ArrayD(const char *name, TArrayD &arr)
+   {
+      Int_t len = Length(name);
+      arr.Set(len);
+      if (len > 0)
+         Array(name, arr.fArray, len);
+   }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Write TObject and TNamed members
+
+void WriteNamed(TJSONWriter &w, const TNamed *obj, const char *typname)
+{
+   w.Begin(typname);
+   w.Member("fUniqueID").Number(obj->GetUniqueID());
+   w.Member("fBits").Number((UInt_t)obj->TestBits(~(UInt_t)(TObject::kIsOnHeap | TObject::kNotDeleted)));
+   w.Member("fName").String(obj->GetName());
+   w.Member("fTitle").String(obj->GetTitle());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read TObject and TNamed members
+
+void ReadNamed(TJSONReader &r, TNamed *obj)
+{
+   obj->SetUniqueID(r.Int("fUniqueID"));
+   // stored bits replace all status bits, like in TObject::Streamer
+   obj->ResetBit(TObject::kBitMask);
+   obj->SetBit((UInt_t)r.Int("fBits") & TObject::kBitMask);
+   obj->TNamed::SetName(r.String("fName").c_str());
+   obj->TNamed::SetTitle(r.String("fTitle").c_str());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Write histogram axis
+
+void WriteAxis(TJSONWriter &w, const TAxis *axis)
+{
+   WriteNamed(w, axis, "TAxis");
+   w.Member("fNdivisions").Number(axis->GetNdivisions());
+   w.Member("fAxisColor").Number(axis->GetAxisColor());
+   w.Member("fLabelColor").Number(axis->GetLabelColor());
+   w.Member("fLabelFont").Number(axis->GetLabelFont());
+   w.Member("fLabelOffset").Number(axis->GetLabelOffset());
+   w.Member("fLabelSize").Number(axis->GetLabelSize());
+   w.Member("fTickLength").Number(axis->GetTickLength());
+   w.Member("fTitleOffset").Number(axis->GetTitleOffset());
+   w.Member("fTitleSize").Number(axis->GetTitleSize());
+   w.Member("fTitleColor").Number(axis->GetTitleColor());
+   w.Member("fTitleFont").Number(axis->GetTitleFont());
+   w.Member("fNbins").Number(axis->GetNbins());
+   w.Member("fXmin").Number(axis->*TAxisAccess::Xmin);
+   w.Member("fXmax").Number(axis->*TAxisAccess::Xmax);
+   w.Member("fXbins").Array(axis->GetXbins()->fArray, axis->GetXbins()->fN);
+   w.Member("fFirst").Number(axis->*TAxisAccess::First);
+   w.Member("fLast").Number(axis->*TAxisAccess::Last);
+   w.Member("fBits2").Number(axis->*TAxisAccess::Bits2);
+   w.Member("fTimeDisplay").Bool(axis->*TAxisAccess::TimeDisplay);
+   w.Member("fTimeFormat").String((axis->*TAxisAccess::TimeFormat).Data());
+   w.Member("fLabels").Null();
+   w.Member("fModLabs").Null();
+   w.End();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read histogram axis, returns number of bins
+
+Int_t ReadAxis(TJSONReader r, TAxis *axis)
+{
+   if (!r.IsNull("fLabels") || !r.IsNull("fModLabs") || (r.String("_typename") != "TAxis"))
+      return -1;
+
+   ReadNamed(r, axis);
+
+   Int_t nbins = r.Int("fNbins");
+   Double_t xmin = r.Real("fXmin"), xmax = r.Real("fXmax");
+   Int_t nxbins = r.Length("fXbins");
+   if ((nbins <= 0) || (nxbins && (nxbins != nbins + 1)) || !r.IsValid())
+      return -1;
+
+   if (nxbins > 0) {
+      std::vector<Double_t> xbins(nxbins);
+      r.Array("fXbins", xbins.data(), nxbins);
+      axis->Set(nbins, xbins.data());
+   } else {
+      axis->Set(nbins, xmin, xmax);
+   }
+   axis->*TAxisAccess::Xmin = xmin;
+   axis->*TAxisAccess::Xmax = xmax;
+
+   axis->*TAttAxisAccess::Ndivisions = r.Int("fNdivisions");
+   axis->SetAxisColor(r.Int("fAxisColor"));
+   axis->SetLabelColor(r.Int("fLabelColor"));
+   axis->SetLabelFont(r.Int("fLabelFont"));
+   axis->SetLabelOffset(r.Real("fLabelOffset"));
+   axis->SetLabelSize(r.Real("fLabelSize"));
+   axis->SetTickLength(r.Real("fTickLength"));
+   axis->SetTitleOffset(r.Real("fTitleOffset"));
+   axis->SetTitleSize(r.Real("fTitleSize"));
+   axis->SetTitleColor(r.Int("fTitleColor"));
+   axis->SetTitleFont(r.Int("fTitleFont"));
+   axis->*TAxisAccess::First = r.Int("fFirst");
+   axis->*TAxisAccess::Last = r.Int("fLast");
+   axis->*TAxisAccess::Bits2 = r.Int("fBits2");
+   axis->*TAxisAccess::TimeDisplay = r.Bool("fTimeDisplay");
+   axis->*TAxisAccess::TimeFormat = r.String("fTimeFormat").c_str();
+
+   return nbins;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Codec for histogram classes
+/// HIST is histogram class, ARR - array class with bins content
+
+template <class HIST, class ARR>
+class THistCodec : public TJSONCodec {
+
+   static constexpr Bool_t kIsProfile = std::is_same<HIST, TProfile>::value;
+   static constexpr Bool_t kIs2D = std::is_base_of<TH2, HIST>::value;
+   static constexpr Bool_t kIs3D = std::is_base_of<TH3, HIST>::value;
+
+   /// Check if histogram can be written by codec
+   /// Functions, labels and buffer are left for generic streaming
+   static Bool_t Supported(const HIST *h)
+   {
+      if ((h->GetListOfFunctions() && (h->GetListOfFunctions()->GetSize() > 0)) || (h->*TH1Access::Buffer))
+         return kFALSE;
+      for (const TAxis *axis : {h->GetXaxis(), h->GetYaxis(), h->GetZaxis()})
+         if (axis->GetLabels() || axis->GetModifiedLabels())
+            return kFALSE;
+      return kTRUE;
+   }
+
+   /// Write all histogram members
+   static void WriteHist(TJSONWriter &w, const HIST *h)
+   {
+      const ARR &arr = *h;
+
+      WriteNamed(w, h, h->ClassName());
+      w.Member("fLineColor").Number(h->GetLineColor());
+      w.Member("fLineStyle").Number(h->GetLineStyle());
+      w.Member("fLineWidth").Number(h->GetLineWidth());
+      w.Member("fFillColor").Number(h->GetFillColor());
+      w.Member("fFillStyle").Number(h->GetFillStyle());
+      w.Member("fMarkerColor").Number(h->GetMarkerColor());
+      w.Member("fMarkerStyle").Number(h->GetMarkerStyle());
+      w.Member("fMarkerSize").Number(h->GetMarkerSize());
+      w.Member("fNcells").Number(h->*TH1Access::Ncells);
+      w.Member("fXaxis");
+      WriteAxis(w, h->GetXaxis());
+      w.Member("fYaxis");
+      WriteAxis(w, h->GetYaxis());
+      w.Member("fZaxis");
+      WriteAxis(w, h->GetZaxis());
+      w.Member("fBarOffset").Number(h->*TH1Access::BarOffset);
+      w.Member("fBarWidth").Number(h->*TH1Access::BarWidth);
+      w.Member("fEntries").Number(h->*TH1Access::Entries);
+      w.Member("fTsumw").Number(h->*TH1Access::Tsumw);
+      w.Member("fTsumw2").Number(h->*TH1Access::Tsumw2);
+      w.Member("fTsumwx").Number(h->*TH1Access::Tsumwx);
+      w.Member("fTsumwx2").Number(h->*TH1Access::Tsumwx2);
+      w.Member("fMaximum").Number(h->*TH1Access::Maximum);
+      w.Member("fMinimum").Number(h->*TH1Access::Minimum);
+      w.Member("fNormFactor").Number(h->*TH1Access::NormFactor);
+      w.Member("fContour").Array((h->*TH1Access::Contour).fArray, (h->*TH1Access::Contour).fN);
+      w.Member("fSumw2").BinsArray((h->*TH1Access::Sumw2).fArray, (h->*TH1Access::Sumw2).fN);
+      w.Member("fOption").String((h->*TH1Access::Option).Data());
+      w.Member("fFunctions").Begin("TList");
+      w.Member("name").String("TList");
+      w.Member("arr").Array((Double_t *)nullptr, 0);
+      w.Member("opt").Array((Double_t *)nullptr, 0);
+      w.End();
+      w.Member("fBufferSize").Number(0);
+      w.Member("fBuffer").Array((Double_t *)nullptr, 0);
+      w.Member("fBinStatErrOpt").Number((Int_t)(h->*TH1Access::BinStatErrOpt));
+      w.Member("fStatOverflows").Number((Int_t)(h->*TH1Access::StatOverflows));
+
+      if constexpr (kIs2D) {
+         w.Member("fScalefactor").Number(h->*TH2Access::Scalefactor);
+         w.Member("fTsumwy").Number(h->*TH2Access::Tsumwy);
+         w.Member("fTsumwy2").Number(h->*TH2Access::Tsumwy2);
+         w.Member("fTsumwxy").Number(h->*TH2Access::Tsumwxy);
+      }
+
+      if constexpr (kIs3D) {
+         w.Member("fTsumwy").Number(h->*TH3Access::Tsumwy);
+         w.Member("fTsumwy2").Number(h->*TH3Access::Tsumwy2);
+         w.Member("fTsumwxy").Number(h->*TH3Access::Tsumwxy);
+         w.Member("fTsumwz").Number(h->*TH3Access::Tsumwz);
+         w.Member("fTsumwz2").Number(h->*TH3Access::Tsumwz2);
+         w.Member("fTsumwxz").Number(h->*TH3Access::Tsumwxz);
+         w.Member("fTsumwyz").Number(h->*TH3Access::Tsumwyz);
+      }
+
+      w.Member("fArray").BinsArray(arr.fArray, arr.fN);
+
+      if constexpr (kIsProfile) {
+         const TArrayD &entries = h->*TProfileAccess::BinEntries, &sumw2 = h->*TProfileAccess::BinSumw2;
+         w.Member("fBinEntries").BinsArray(entries.fArray, entries.fN);
+         w.Member("fErrorMode").Number((Int_t)(h->*TProfileAccess::ErrorMode));
+         w.Member("fYmin").Number(h->*TProfileAccess::Ymin);
+         w.Member("fYmax").Number(h->*TProfileAccess::Ymax);
+         w.Member("fScaling").Bool(h->*TProfileAccess::Scaling);
+         w.Member("fTsumwy").Number(h->*TProfileAccess::Tsumwy);
+         w.Member("fTsumwy2").Number(h->*TProfileAccess::Tsumwy2);
+         w.Member("fBinSumw2").BinsArray(sumw2.fArray, sumw2.fN);
+      }
+
+      w.End();
+   }
+
+public:
+   Bool_t Write(std::string &out, const void *obj) const override
+   {
+      const HIST *h = (const HIST *)obj;
+      if (!Supported(h))
+         return kFALSE;
+
+      TJSONWriter w(out);
+      WriteHist(w, h);
+      return w.IsValid();
+   }
+
+   Bool_t WriteStream(const void *obj, std::size_t chunk, const Sink_t &sink) const override
+   {
+      const HIST *h = (const HIST *)obj;
+      if (!Supported(h))
+         return kFALSE;
+
+      std::string out;
+      out.reserve(chunk + 64);
+      TJSONWriter w(out, chunk, sink);
+      WriteHist(w, h);
+      w.Flush();
+      return w.IsValid();
+   }
+
+   void *Read(std::string_view json, const TClass *cl) const override
+   {
+      std::unique_ptr<HIST> guard((HIST *)cl->New());
+      if (!guard || !ReadInto(json, guard.get(), cl))
+         return nullptr;
+      return guard.release();
+   }
+
+   Bool_t ReadInto(std::string_view json, void *obj, const TClass *cl) const override
+   {
+      HIST *h = (HIST *)obj;
+
+      // target with functions, labels or buffer is left for generic streaming
+      if (!Supported(h))
+         return kFALSE;
+
+      // tape memory is reused by following reads in the same thread
+      static thread_local TJSONTape tape;
+      tape.Reset(json);
+      Bool_t valid = kTRUE;
+      TJSONReader r(tape.Root(), &valid);
+
+      return ReadHist(r, h, cl);
+   }
+
+   Bool_t ReadStream(std::string_view skeleton, TJSONPullParser &pull, void *obj, const TClass *cl) const override
+   {
+      HIST *h = (HIST *)obj;
+
+      if (!Supported(h))
+         return kFALSE;
+
+      // bins arrays are decoded by pull parser directly into histogram
+      TJSONTape tape(skeleton);
+      Bool_t valid = kTRUE;
+      TJSONReader r(tape.Root(), &valid, &pull);
+
+      return ReadHist(r, h, cl);
+   }
+
+private:
+   /// Read all histogram members
+   static Bool_t ReadHist(TJSONReader &r, HIST *h, const TClass *cl)
+   {
+      if (!r.IsValid() || (r.String("_typename") != cl->GetName()))
+         return kFALSE;
+
+      // functions and buffer are left for generic streaming
+      auto funcs = r.Get("fFunctions", TJSONTape::kObject)["arr"];
+      if ((funcs.IsValid() && funcs.GetSize() > 0) || r.Int("fBufferSize") || r.Length("fBuffer") || !r.IsValid())
+         return kFALSE;
+
+      ARR &arr = *h;
+
+      ReadNamed(r, h);
+      h->SetLineColor(r.Int("fLineColor"));
+      h->SetLineStyle(r.Int("fLineStyle"));
+      h->SetLineWidth(r.Int("fLineWidth"));
+      h->SetFillColor(r.Int("fFillColor"));
+      h->SetFillStyle(r.Int("fFillStyle"));
+      h->SetMarkerColor(r.Int("fMarkerColor"));
+      h->SetMarkerStyle(r.Int("fMarkerStyle"));
+      h->SetMarkerSize(r.Real("fMarkerSize"));
+
+      Int_t nx = ReadAxis(r.Sub("fXaxis"), h->GetXaxis());
+      Int_t ny = ReadAxis(r.Sub("fYaxis"), h->GetYaxis());
+      Int_t nz = ReadAxis(r.Sub("fZaxis"), h->GetZaxis());
+      if ((nx <= 0) || (ny <= 0) || (nz <= 0))
+         return kFALSE;
+
+      Int_t ncells = nx + 2;
+      if (kIs2D || kIs3D)
+         ncells *= ny + 2;
+      if (kIs3D)
+         ncells *= nz + 2;
+      if (r.Int("fNcells") != ncells)
+         return kFALSE;
+
+      h->*TH1Access::Ncells = ncells;
+      h->*TH1Access::BarOffset = r.Int("fBarOffset");
+      h->*TH1Access::BarWidth = r.Int("fBarWidth");
+      h->*TH1Access::Entries = r.Real("fEntries");
+      h->*TH1Access::Tsumw = r.Real("fTsumw");
+      h->*TH1Access::Tsumw2 = r.Real("fTsumw2");
+      h->*TH1Access::Tsumwx = r.Real("fTsumwx");
+      h->*TH1Access::Tsumwx2 = r.Real("fTsumwx2");
+      h->*TH1Access::Maximum = r.Real("fMaximum");
+      h->*TH1Access::Minimum = r.Real("fMinimum");
+      h->*TH1Access::NormFactor = r.Real("fNormFactor");
+      r.ArrayD("fContour", h->*TH1Access::Contour);
+      r.ArrayD("fSumw2", h->*TH1Access::Sumw2);
+      h->*TH1Access::Option = r.String("fOption").c_str();
+      h->*TH1Access::BinStatErrOpt = (TH1::EBinErrorOpt)r.Int("fBinStatErrOpt");
+      h->*TH1Access::StatOverflows = (TH1::EStatOverflows)r.Int("fStatOverflows");
+
+      if constexpr (kIs2D) {
+         h->*TH2Access::Scalefactor = r.Real("fScalefactor");
+         h->*TH2Access::Tsumwy = r.Real("fTsumwy");
+         h->*TH2Access::Tsumwy2 = r.Real("fTsumwy2");
+         h->*TH2Access::Tsumwxy = r.Real("fTsumwxy");
+      }
+
+      if constexpr (kIs3D) {
+         h->*TH3Access::Tsumwy = r.Real("fTsumwy");
+         h->*TH3Access::Tsumwy2 = r.Real("fTsumwy2");
+         h->*TH3Access::Tsumwxy = r.Real("fTsumwxy");
+         h->*TH3Access::Tsumwz = r.Real("fTsumwz");
+         h->*TH3Access::Tsumwz2 = r.Real("fTsumwz2");
+         h->*TH3Access::Tsumwxz = r.Real("fTsumwxz");
+         h->*TH3Access::Tsumwyz = r.Real("fTsumwyz");
+      }
+
+      arr.Set(ncells);
+      r.Array("fArray", arr.fArray, ncells);
+
+      if constexpr (kIsProfile) {
+         TArrayD &entries = h->*TProfileAccess::BinEntries;
+         entries.Set(ncells);
+         r.Array("fBinEntries", entries.fArray, ncells);
+         h->*TProfileAccess::ErrorMode = (EErrorType)r.Int("fErrorMode");
+         h->*TProfileAccess::Ymin = r.Real("fYmin");
+         h->*TProfileAccess::Ymax = r.Real("fYmax");
+         h->*TProfileAccess::Scaling = r.Bool("fScaling");
+         h->*TProfileAccess::Tsumwy = r.Real("fTsumwy");
+         h->*TProfileAccess::Tsumwy2 = r.Real("fTsumwy2");
+         r.ArrayD("fBinSumw2", h->*TProfileAccess::BinSumw2);
+      }
+
+      return r.IsValid();
+   }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Registry of codecs, filled with built-in codecs at first use
+
+std::map<const TClass *, std::unique_ptr<TJSONCodec>> &GetCodecs()
+{
+   static std::map<const TClass *, std::unique_ptr<TJSONCodec>> codecs = [] {
+      std::map<const TClass *, std::unique_ptr<TJSONCodec>> res;
+      res[TH1F::Class()] = std::make_unique<THistCodec<TH1F, TArrayF>>();
+      res[TH1D::Class()] = std::make_unique<THistCodec<TH1D, TArrayD>>();
+      res[TH1I::Class()] = std::make_unique<THistCodec<TH1I, TArrayI>>();
+      res[TH2F::Class()] = std::make_unique<THistCodec<TH2F, TArrayF>>();
+      res[TH2D::Class()] = std::make_unique<THistCodec<TH2D, TArrayD>>();
+      res[TH3F::Class()] = std::make_unique<THistCodec<TH3F, TArrayF>>();
+      res[TH3D::Class()] = std::make_unique<THistCodec<TH3D, TArrayD>>();
+      res[TProfile::Class()] = std::make_unique<THistCodec<TProfile, TArrayD>>();
+      return res;
+   }();
+
+   return codecs;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+/// Register codec for the class, registry takes ownership over codec
+/// Existing codec for the class is replaced, nullptr removes codec
+/// Should be done before files are used, registry is not protected for concurrent access
+
+void TJSONCodec::Register(const TClass *cl, TJSONCodec *codec)
+{
+   if (!cl)
+      return;
+
+   if (codec)
+      GetCodecs()[cl].reset(codec);
+   else
+      GetCodecs().erase(cl);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Find codec for the class, only exact class match is used
+
+const TJSONCodec *TJSONCodec::Find(const TClass *cl)
+{
+   if (!cl)
+      return nullptr;
+
+   auto &codecs = GetCodecs();
+   auto iter = codecs.find(cl);
+   return iter != codecs.end() ? iter->second.get() : nullptr;
+}
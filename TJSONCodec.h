@@ -0,0 +1,64 @@
+// Author: agent  16.10.2026
+
+/*************************************************************************
+ * Copyright (C) 1995-2026, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TJSONCodec
+#define ROOT_TJSONCodec
+
+#include "RtypesCore.h"
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+class TClass;
+class TJSONPullParser;
+
+class TJSONCodec {
+
+public:
+   /// Receives next piece of produced JSON, returns kFALSE if piece cannot be stored
+   using Sink_t = std::function<Bool_t(const char *buf, std::size_t len)>;
+
+   virtual ~TJSONCodec() = default;
+
+   /// Append JSON of the object to out, returns kFALSE if object cannot be handled by codec
+   virtual Bool_t Write(std::string &out, const void *obj) const = 0;
+
+   /// Produce JSON of the object in pieces of about chunk bytes, every piece is passed to sink
+   /// Returns kFALSE if object cannot be handled by codec, already passed pieces must be discarded then
+   /// Default implementation produces complete JSON with Write() and passes it as single piece
+   virtual Bool_t WriteStream(const void *obj, std::size_t /* chunk */, const Sink_t &sink) const
+   {
+      std::string out;
+      return Write(out, obj) && sink(out.data(), out.length());
+   }
+
+   /// Create object of class cl from JSON text, returns nullptr if text cannot be handled by codec
+   virtual void *Read(std::string_view json, const TClass *cl) const = 0;
+
+   /// Read JSON text into existing object of class cl, returns kFALSE if not supported by codec
+   /// Object content is undefined when reading fails
+   virtual Bool_t ReadInto(std::string_view /* json */, void * /* obj */, const TClass * /* cl */) const { return kFALSE; }
+
+   /// Read into existing object of class cl, when JSON is too large to be kept in memory
+   /// skeleton is JSON of the object, where large members are replaced by null,
+   /// values of such members are decoded with pull parser, see TJSONPullParser::ReadSkeleton()
+   /// Returns kFALSE if not supported by codec, object content is undefined then
+   virtual Bool_t ReadStream(std::string_view /* skeleton */, TJSONPullParser & /* pull */, void * /* obj */,
+                             const TClass * /* cl */) const
+   {
+      return kFALSE;
+   }
+
+   static void Register(const TClass *cl, TJSONCodec *codec);
+   static const TJSONCodec *Find(const TClass *cl);
+};
+
+#endif
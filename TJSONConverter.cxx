@@ -0,0 +1,430 @@
+// Author: agent  16.10.2026
+
+/*************************************************************************
+ * Copyright (C) 1995-2026, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//________________________________________________________________________
+//
+// TJSONConverter converts binary ROOT files into TJSONFile and back.
+//
+//   TJSONConverter conv;
+//   conv.ExcludeClass("TTree");
+//   conv.Convert("data.root", "data.json");
+//
+// Direction is defined by file names: file with ".root" suffix is binary
+// ROOT file, any other is TJSONFile.
+//
+// Keys of source file are listed first, including all subdirectories.
+// Then pool of threads reads objects - every thread opens own instance of
+// source file. When output is TJSONFile, objects are converted to JSON in
+// the reading thread as well. Main thread writes results strictly in
+// order of source keys, therefore output does not depend on number of
+// threads. Reading threads can run ahead of writing only by limited number
+// of keys, which limits memory usage.
+//
+// All cycles of every key are converted, cycles are written in increasing
+// order. Cycle numbers are assigned by the output file, therefore gaps in
+// cycle numbers of the source file (for example after deleted cycles) are
+// not kept: cycles 2 and 5 of the source become cycles 1 and 2 of the output.
+// TTree is read and written to TJSONFile in main thread, since its
+// entries are read from the source file while tree is stored.
+//
+// With kCBOR encoding produced JSON document is written in CBOR format.
+// Text document is written first and then converted event by event by SAX
+// parser, objects and arrays get CBOR indefinite length. Therefore complete
+// document is never kept in memory, only single string value at once.
+// Such file is intended for external tools, TJSONFile cannot read it.
+//________________________________________________________________________
+
+#include "TJSONConverter.h"
+
+#include "TJSONFile.h"
+#include "TKeyJSON.h"
+#include "TJSONBufferMerger.h"
+#include "TROOT.h"
+#include "TSystem.h"
+#include "TKey.h"
+#include "TClass.h"
+#include "TTree.h"
+#include "TError.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+struct TJSONConvItem {
+   std::string fDir;                      ///< path of directory
+   std::string fName;                     ///< key name
+   std::string fTitle;                    ///< key title
+   std::string fClassName;                ///< class of object
+   Short_t fCycle{0};                     ///< key cycle
+   Bool_t fIsDir{kFALSE};                 ///< key is subdirectory
+   Bool_t fMainThread{kFALSE};            ///< object is read and written in main thread
+   Bool_t fReady{kFALSE};                 ///< item is processed and can be written
+   Bool_t fFailed{kFALSE};                ///< object cannot be read or converted
+   TJSONBufferWriter::Record fRecord;     ///< JSON of object, when output is TJSONFile
+   void *fObj{nullptr};                   ///< object, when output is binary file
+   TClass *fClass{nullptr};               ///< class of object
+};
+
+/// Open source or output file, type is defined by file name
+TFile *OpenFile(const char *fname, Option_t *option, Int_t compression = ROOT::RCompressionSetting::EDefaults::kUseCompiledDefault)
+{
+   TFile *f = nullptr;
+   if (TString(fname).EndsWith(".root"))
+      f = TFile::Open(fname, option, "", compression);
+   else
+      f = new TJSONFile(fname, option, "title", compression);
+
+   if (f && f->IsZombie()) {
+      delete f;
+      f = nullptr;
+   }
+
+   return f;
+}
+
+/// Read object of the item from source file, convert to JSON when required
+/// Object read without conversion is detached from source file, if specified
+void ProcessItem(TFile *f, TJSONConvItem &item, Bool_t tojson, Bool_t detach)
+{
+   TDirectory *dir = item.fDir.empty() ? f : f->GetDirectory(item.fDir.c_str());
+   TKey *key = dir ? dir->GetKey(item.fName.c_str(), item.fCycle) : nullptr;
+   TClass *cl = TClass::GetClass(item.fClassName.c_str());
+   void *obj = key && cl ? key->ReadObjectAny(cl) : nullptr;
+
+   if (!obj) {
+      item.fFailed = kTRUE;
+      return;
+   }
+
+   if (tojson) {
+      if (!TJSONBufferWriter::MakeRecord(item.fRecord, obj, cl, item.fName.c_str(), item.fTitle.c_str()))
+         item.fFailed = kTRUE;
+      cl->Destructor(obj);
+   } else {
+      // object must survive closing of source file
+      if (auto func = detach ? cl->GetDirectoryAutoAdd() : nullptr)
+         func(obj, nullptr);
+      item.fObj = obj;
+      item.fClass = cl;
+   }
+}
+
+/// SAX handler, which writes parsed JSON document in CBOR encoding
+/// Offsets of text document (KeysIndex and IndexSeek members) are skipped
+class TJSONCborWriter : public nlohmann::json_sax<nlohmann::json> {
+   std::ostream &fOut;   ///< output stream
+   Int_t fDepth{0};      ///< current nesting level
+   Int_t fSkipDepth{-1}; ///< nesting level of skipped member, -1 - nothing skipped
+
+   /// Write CBOR of single value
+   Bool_t Write(const nlohmann::json &value)
+   {
+      auto cbor = nlohmann::json::to_cbor(value);
+      fOut.write((const char *)cbor.data(), cbor.size());
+      return fOut.good();
+   }
+
+   /// Start object or array
+   Bool_t Start(unsigned char code)
+   {
+      fDepth++;
+      if (fSkipDepth >= 0)
+         return kTRUE;
+      fOut.put(code);
+      return fOut.good();
+   }
+
+   /// End object or array
+   Bool_t End()
+   {
+      fDepth--;
+      if (Skip())
+         return kTRUE;
+      fOut.put((char)0xff);
+      return fOut.good();
+   }
+
+   /// Returns kTRUE if current value is skipped, skipping ends with the value of the member
+   Bool_t Skip()
+   {
+      if (fSkipDepth < 0)
+         return kFALSE;
+      if (fDepth == fSkipDepth)
+         fSkipDepth = -1;
+      return kTRUE;
+   }
+
+public:
+   TJSONCborWriter(std::ostream &out) : fOut(out) {}
+
+   bool null() override { return Skip() || Write(nlohmann::json()); }
+   bool boolean(bool val) override { return Skip() || Write(nlohmann::json(val)); }
+   bool number_integer(number_integer_t val) override { return Skip() || Write(nlohmann::json(val)); }
+   bool number_unsigned(number_unsigned_t val) override { return Skip() || Write(nlohmann::json(val)); }
+   bool number_float(number_float_t val, const string_t &) override { return Skip() || Write(nlohmann::json(val)); }
+   bool string(string_t &val) override { return Skip() || Write(nlohmann::json(val)); }
+   bool binary(binary_t &val) override { return Skip() || Write(nlohmann::json(val)); }
+
+   // containers are written with indefinite length, terminated by break code
+   bool start_object(std::size_t) override { return Start(0xbf); }
+   bool start_array(std::size_t) override { return Start(0x9f); }
+   bool end_object() override { return End(); }
+   bool end_array() override { return End(); }
+
+   bool key(string_t &val) override
+   {
+      if (fSkipDepth >= 0)
+         return true;
+      // offsets in text document are meaningless
+      if ((fDepth == 1) && ((val == jsonio::KeysIndex) || (val == jsonio::IndexSeek))) {
+         fSkipDepth = fDepth;
+         return true;
+      }
+      return Write(nlohmann::json(val));
+   }
+
+   bool parse_error(std::size_t pos, const std::string &, const nlohmann::detail::exception &ex) override
+   {
+      ::Error("TJSONConverter::Convert", "Fail to parse produced document at position %lu: %s", (unsigned long)pos,
+              ex.what());
+      return false;
+   }
+};
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+/// Check if objects of the class should be converted
+
+Bool_t TJSONConverter::Accept(const TClass *cl) const
+{
+   if (!cl)
+      return kFALSE;
+
+   for (auto &name : fExclude)
+      if (cl->InheritsFrom(name.c_str()))
+         return kFALSE;
+
+   if (fInclude.empty())
+      return kTRUE;
+
+   for (auto &name : fInclude)
+      if (cl->InheritsFrom(name.c_str()))
+         return kTRUE;
+
+   return kFALSE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Convert file src into file dst
+/// Returns kFALSE if any object cannot be converted
+
+Bool_t TJSONConverter::Convert(const char *src, const char *dst)
+{
+   if (!src || !dst || !*src || !*dst)
+      return kFALSE;
+
+   if (!fForce && !gSystem->AccessPathName(dst, kFileExists)) {
+      ::Error("TJSONConverter::Convert", "Output file %s already exists", dst);
+      return kFALSE;
+   }
+
+   Bool_t tojson = !TString(dst).EndsWith(".root");
+
+   std::unique_ptr<TFile> in(OpenFile(src, "read"));
+   if (!in) {
+      ::Error("TJSONConverter::Convert", "Fail to open source file %s", src);
+      return kFALSE;
+   }
+
+   // list all keys, cycles of same key follow each other in increasing order
+   std::vector<TJSONConvItem> items;
+
+   std::function<void(TDirectory *, const std::string &)> listdir = [&](TDirectory *dir, const std::string &path) {
+      std::vector<TKey *> keys;
+      std::unordered_map<std::string, std::size_t> first;
+      TIter iter(dir->GetListOfKeys());
+      while (auto key = (TKey *)iter()) {
+         first.emplace(key->GetName(), first.size());
+         keys.emplace_back(key);
+      }
+      std::stable_sort(keys.begin(), keys.end(), [&first](TKey *k1, TKey *k2) {
+         auto n1 = first[k1->GetName()], n2 = first[k2->GetName()];
+         return n1 != n2 ? n1 < n2 : k1->GetCycle() < k2->GetCycle();
+      });
+
+      for (auto key : keys) {
+         TClass *cl = TClass::GetClass(key->GetClassName());
+         Bool_t isdir = cl && cl->InheritsFrom(TDirectory::Class());
+         if (!isdir && !Accept(cl))
+            continue;
+
+         TJSONConvItem item;
+         item.fDir = path;
+         item.fName = key->GetName();
+         item.fTitle = key->GetTitle();
+         item.fClassName = key->GetClassName();
+         item.fCycle = key->GetCycle();
+         item.fIsDir = isdir;
+         item.fMainThread = isdir || (tojson && cl->InheritsFrom(TTree::Class()));
+         item.fReady = item.fMainThread;
+         items.emplace_back(std::move(item));
+
+         if (isdir)
+            if (auto subdir = dir->GetDirectory(key->GetName()))
+               listdir(subdir, path.empty() ? key->GetName() : path + "/" + key->GetName());
+      }
+   };
+
+   listdir(in.get(), "");
+
+   // CBOR is produced from written JSON document
+   std::string outname = dst;
+   if (tojson && (fEncoding == kCBOR))
+      outname.append(".tmp.json");
+
+   std::unique_ptr<TFile> out(OpenFile(outname.c_str(), "recreate", fCompression));
+   if (!out) {
+      ::Error("TJSONConverter::Convert", "Fail to create output file %s", outname.c_str());
+      return kFALSE;
+   }
+
+   Int_t nitems = items.size();
+   Int_t nthreads = fNumThreads > 0 ? fNumThreads : (Int_t)std::thread::hardware_concurrency();
+   nthreads = std::max(1, std::min(nthreads, nitems));
+   Int_t window = 4 * nthreads; // how far readers can run ahead of writer
+
+   if (nthreads > 1)
+      ROOT::EnableThreadSafety();
+
+   std::mutex mutex;
+   std::condition_variable cond;
+   Int_t next = 0, written = 0;
+   Bool_t failed = kFALSE;
+
+   auto worker = [&]() {
+      std::unique_ptr<TFile> f(OpenFile(src, "read"));
+
+      std::unique_lock<std::mutex> lock(mutex);
+      if (!f) {
+         ::Error("TJSONConverter::Convert", "Fail to open source file %s", src);
+         failed = kTRUE;
+         cond.notify_all();
+         return;
+      }
+
+      while (true) {
+         cond.wait(lock, [&] { return failed || (next >= nitems) || (next < written + window); });
+         if (failed || (next >= nitems))
+            break;
+
+         auto &item = items[next++];
+         if (item.fMainThread)
+            continue;
+
+         lock.unlock();
+         ProcessItem(f.get(), item, tojson, kTRUE);
+         lock.lock();
+
+         item.fReady = kTRUE;
+         cond.notify_all();
+      }
+
+      lock.unlock();
+      f->Close();
+   };
+
+   std::vector<std::thread> threads;
+   for (Int_t n = 0; n < nthreads; n++)
+      threads.emplace_back(worker);
+
+   Bool_t res = kTRUE;
+
+   for (Int_t n = 0; n < nitems; n++) {
+      auto &item = items[n];
+
+      {
+         std::unique_lock<std::mutex> lock(mutex);
+         cond.wait(lock, [&] { return failed || item.fReady; });
+         if (failed)
+            break;
+      }
+
+      TDirectory *outdir = item.fDir.empty() ? out.get() : out->mkdir(item.fDir.c_str(), "", kTRUE);
+
+      if (item.fIsDir) {
+         if (outdir)
+            outdir->mkdir(item.fName.c_str(), item.fTitle.c_str(), kTRUE);
+      } else if (item.fMainThread) {
+         // tree remains attached to source file, baskets are read while tree is stored
+         ProcessItem(in.get(), item, kFALSE, kFALSE);
+      }
+
+      if (item.fFailed || !outdir) {
+         ::Error("TJSONConverter::Convert", "Fail to convert object %s;%d", item.fName.c_str(), item.fCycle);
+         res = kFALSE;
+      } else if (item.fObj) {
+         outdir->WriteObjectAny(item.fObj, item.fClass, item.fName.c_str());
+         item.fClass->Destructor(item.fObj);
+         item.fObj = nullptr;
+      } else if (!item.fIsDir) {
+         auto &rec = item.fRecord;
+         ((TJSONFile *)out.get())->CreateKey(outdir, rec.fName.c_str(), rec.fTitle.c_str(), rec.fClassName.c_str(),
+                                             rec.fPayload, rec.fObject.get(), rec.fSize);
+         rec.fObject.reset();
+      }
+
+      {
+         std::lock_guard<std::mutex> lock(mutex);
+         written = n + 1;
+      }
+      cond.notify_all();
+   }
+
+   for (auto &thrd : threads)
+      thrd.join();
+
+   // objects, not written because of failure
+   for (auto &item : items)
+      if (item.fObj)
+         item.fClass->Destructor(item.fObj);
+
+   out->Close();
+   in->Close();
+
+   if (failed)
+      return kFALSE;
+
+   if (tojson && (fEncoding == kCBOR)) {
+      std::ifstream is(outname);
+      std::ofstream os(dst, std::ios::binary);
+      TJSONCborWriter writer(os);
+      Bool_t ok = is && os && nlohmann::json::sax_parse(is, &writer);
+      os.close();
+      ok = ok && !os.fail();
+      gSystem->Unlink(outname.c_str());
+      if (!ok) {
+         ::Error("TJSONConverter::Convert", "Fail to convert produced file %s into CBOR", outname.c_str());
+         gSystem->Unlink(dst);
+         return kFALSE;
+      }
+   }
+
+   return res;
+}
@@ -0,0 +1,60 @@
+// Author: agent  16.10.2026
+
+/*************************************************************************
+ * Copyright (C) 1995-2026, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TJSONConverter
+#define ROOT_TJSONConverter
+
+#include "RtypesCore.h"
+#include "Compression.h"
+
+#include <string>
+#include <vector>
+
+class TClass;
+
+class TJSONConverter {
+
+public:
+   enum EEncoding { kText, kCBOR };
+
+private:
+   TJSONConverter(const TJSONConverter &) = delete;            // TJSONConverter cannot be copied
+   TJSONConverter &operator=(const TJSONConverter &) = delete; // TJSONConverter cannot be copied
+
+   std::vector<std::string> fInclude; //! classes to convert, empty - all classes
+   std::vector<std::string> fExclude; //! classes to skip
+   Int_t fNumThreads{0};              //! number of reading threads, 0 - number of cores
+   Int_t fCompression{ROOT::RCompressionSetting::EDefaults::kUseCompiledDefault}; //! compression of output file
+   EEncoding fEncoding{kText};        //! encoding of JSON output
+   Bool_t fForce{kFALSE};             //! overwrite existing output file
+
+   Bool_t Accept(const TClass *cl) const;
+
+public:
+   TJSONConverter() = default;
+
+   void IncludeClass(const char *clname) { fInclude.emplace_back(clname); }
+   void ExcludeClass(const char *clname) { fExclude.emplace_back(clname); }
+
+   void SetNumThreads(Int_t n) { fNumThreads = n > 0 ? n : 0; }
+   Int_t GetNumThreads() const { return fNumThreads; }
+
+   void SetCompression(Int_t settings) { fCompression = settings; }
+   Int_t GetCompression() const { return fCompression; }
+
+   void SetEncoding(EEncoding enc) { fEncoding = enc; }
+   EEncoding GetEncoding() const { return fEncoding; }
+
+   void SetForce(Bool_t on = kTRUE) { fForce = on; }
+
+   Bool_t Convert(const char *src, const char *dst);
+};
+
+#endif
@@ -28,8 +28,13 @@
 // exploiting the ROOT/CINT dictionary. Any class having a dictionary
 // can be saved in XML format.
 //
-// This first implementation does not support subdirectories
-// or Trees.
+// TTree objects are stored in columnar form, one chunk per cluster for
+// each branch, see TJSONTreeReader. Trees with branches other than single
+// leaf of basic type are stored with generic streamer. Only memory-resident
+// trees (or trees from other files) can be written, the TJSONFile itself
+// cannot be used as directory of the tree:
+//   tree->SetDirectory(nullptr);
+//   jsonfile->WriteTObject(tree);
 //
 // The shared library libRXML.so may be loaded dynamically
 // via gSystem->Load("libRXML"). This library is automatically
@@ -84,16 +89,549 @@
 #include "TError.h"
 #include "TClass.h"
 #include "TVirtualMutex.h"
+#include "TBufferJSON.h"
+#include "TJSONCodec.h"
+#include "TJSONTreeReader.h"
+#include "TJSONTape.h"
+#include "TBufferFile.h"
 
 #include <memory>
+#include <functional>
 #include <fstream>
 #include <nlohmann/json.hpp>
 #include <iostream>
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <iterator>
+#include <vector>
+#include <algorithm>
+
 #include <iomanip>
+#include <cstdio>
 
 ClassImp(TJSONFile);
 
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+/// Iterator over file buffer, which reports current position while SAX parser consumes it
+
+class TJSONScanIter {
+   const char *fPtr{nullptr};
+   const char **fPos{nullptr};
+public:
+   using iterator_category = std::input_iterator_tag;
+   using value_type = char;
+   using difference_type = std::ptrdiff_t;
+   using pointer = const char *;
+   using reference = const char &;
+
+   TJSONScanIter(const char *ptr, const char **pos) : fPtr(ptr), fPos(pos) {}
+   reference operator*() const { return *fPtr; }
+   TJSONScanIter &operator++()
+   {
+      *fPos = ++fPtr;
+      return *this;
+   }
+   TJSONScanIter operator++(int)
+   {
+      TJSONScanIter res = *this;
+      ++(*this);
+      return res;
+   }
+   bool operator==(const TJSONScanIter &it) const { return fPtr == it.fPtr; }
+   bool operator!=(const TJSONScanIter &it) const { return fPtr != it.fPtr; }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// SAX handler, which collects only keys attributes and byte ranges of keys records
+/// Objects payload is skipped without building DOM.
+/// Result has same layout as keys index trailer, written by TJSONFile::SaveToFile
+
+class TJSONKeysScanner {
+   enum ERole { kTop, kKeysArray, kKeyRecord, kObject, kObjectRef, kSharedArray, kSharedItem, kSInfos, kSubtrees, kDefaults, kSchemaHashes, kSkip };
+
+   struct Frame {
+      ERole fRole{kSkip};
+      std::string fKey;         // name of current member
+      Long64_t fStart{0};       // start of record in the buffer
+      nlohmann::json fNode;     // index entry for record or entries of keys array
+   };
+
+   const char *fBegin{nullptr};
+   const char *const &fPos;
+   std::vector<Frame> fStack;
+
+   Long64_t Position() const { return fPos - fBegin; }
+
+   void Push(ERole role, Long64_t start = 0)
+   {
+      fStack.emplace_back();
+      fStack.back().fRole = role;
+      fStack.back().fStart = start;
+      if ((role == kKeysArray) || (role == kSchemaHashes))
+         fStack.back().fNode = nlohmann::json::array();
+      else if (role == kKeyRecord)
+         fStack.back().fNode = nlohmann::json::object();
+   }
+
+   template <typename T>
+   bool Value(const T &value)
+   {
+      if (fStack.empty())
+         return true;
+      auto &top = fStack.back();
+      if (top.fRole == kTop) {
+         if (top.fKey != jsonio::SInfos && top.fKey != "Keys" && top.fKey != jsonio::SharedSubtrees)
+            fResult[top.fKey] = value;
+      } else if (top.fRole == kKeyRecord) {
+         if ((top.fKey == jsonio::Name) || (top.fKey == jsonio::Title) || (top.fKey == jsonio::Cycle) ||
+             (top.fKey == jsonio::CreateTm))
+            top.fNode[top.fKey] = value;
+      } else if (top.fRole == kObject) {
+         if (top.fKey == "_typename")
+            fStack[fStack.size() - 2].fNode[jsonio::ObjClass] = value;
+      } else if (top.fRole == kObjectRef) {
+         if (top.fKey == jsonio::ObjClass)
+            fStack[fStack.size() - 2].fNode[jsonio::ObjClass] = value;
+      } else if (top.fRole == kSharedArray) {
+         top.fNode.push_back({0, 0}); // not used shared object
+      } else if (top.fRole == kSchemaHashes) {
+         top.fNode.push_back(value);
+      }
+      return true;
+   }
+
+public:
+   nlohmann::json fResult = nlohmann::json::object(); ///< file attributes and keys index
+   std::string fError;                                ///< parse error message
+
+   TJSONKeysScanner(const char *begin, const char *const &pos) : fBegin(begin), fPos(pos) {}
+
+   bool null() { return Value(nullptr); }
+   bool boolean(bool val) { return Value(val); }
+   bool number_integer(nlohmann::json::number_integer_t val) { return Value(val); }
+   bool number_unsigned(nlohmann::json::number_unsigned_t val) { return Value(val); }
+   bool number_float(nlohmann::json::number_float_t val, const std::string &) { return Value(val); }
+   bool string(std::string &val) { return Value(val); }
+   bool binary(nlohmann::json::binary_t &) { return true; }
+
+   bool key(std::string &val)
+   {
+      fStack.back().fKey = val;
+      return true;
+   }
+
+   bool start_object(std::size_t)
+   {
+      if (fStack.empty())
+         Push(kTop);
+      else if (fStack.back().fRole == kKeysArray)
+         Push(kKeyRecord, Position() - 1);
+      else if ((fStack.back().fRole == kKeyRecord) && (fStack.back().fKey == jsonio::Object))
+         Push(kObject);
+      else if ((fStack.back().fRole == kKeyRecord) &&
+               ((fStack.back().fKey == jsonio::Delta) || (fStack.back().fKey == jsonio::Shared)))
+         Push(kObjectRef);
+      else if (fStack.back().fRole == kSharedArray)
+         Push(kSharedItem, Position() - 1);
+      else if ((fStack.back().fRole == kTop) && (fStack.back().fKey == jsonio::ClassDefaults))
+         Push(kDefaults, Position() - 1);
+      else
+         Push(kSkip);
+      return true;
+   }
+
+   bool end_object()
+   {
+      Frame frame = std::move(fStack.back());
+      fStack.pop_back();
+      if (frame.fRole == kKeyRecord) {
+         frame.fNode["offset"] = frame.fStart;
+         frame.fNode["length"] = Position() - frame.fStart;
+         fStack.back().fNode.push_back(std::move(frame.fNode));
+      } else if (frame.fRole == kSharedItem) {
+         fStack.back().fNode.push_back({frame.fStart, Position() - frame.fStart});
+      } else if (frame.fRole == kDefaults) {
+         fResult[jsonio::KeysIndex]["defaults"] = {frame.fStart, Position() - frame.fStart};
+      }
+      return true;
+   }
+
+   bool start_array(std::size_t)
+   {
+      if (fStack.empty()) {
+         Push(kSkip);
+         return true;
+      }
+      auto &top = fStack.back();
+      if (((top.fRole == kTop) || (top.fRole == kKeyRecord)) && (top.fKey == "Keys"))
+         Push(kKeysArray);
+      else if ((top.fRole == kTop) && (top.fKey == jsonio::SInfos))
+         Push(kSInfos, Position() - 1);
+      else if ((top.fRole == kTop) && (top.fKey == jsonio::SharedObjects))
+         Push(kSharedArray);
+      else if ((top.fRole == kTop) && (top.fKey == jsonio::SharedSubtrees))
+         Push(kSubtrees, Position() - 1);
+      else if ((top.fRole == kTop) && (top.fKey == jsonio::SchemaHashes))
+         Push(kSchemaHashes);
+      else
+         Push(kSkip);
+      return true;
+   }
+
+   bool end_array()
+   {
+      Frame frame = std::move(fStack.back());
+      fStack.pop_back();
+      if (frame.fRole == kKeysArray) {
+         if (fStack.back().fRole == kTop)
+            fResult[jsonio::KeysIndex]["keys"] = std::move(frame.fNode);
+         else
+            fStack.back().fNode["keys"] = std::move(frame.fNode);
+      } else if (frame.fRole == kSInfos) {
+         fResult[jsonio::KeysIndex]["sinfos"] = {frame.fStart, Position() - frame.fStart};
+      } else if (frame.fRole == kSharedArray) {
+         fResult[jsonio::KeysIndex]["shared"] = std::move(frame.fNode);
+      } else if (frame.fRole == kSubtrees) {
+         fResult[jsonio::KeysIndex]["subtrees"] = {frame.fStart, Position() - frame.fStart};
+      } else if (frame.fRole == kSchemaHashes) {
+         fResult[jsonio::SchemaHashes] = std::move(frame.fNode);
+      }
+      return true;
+   }
+
+   bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &ex)
+   {
+      fError = ex.what();
+      return false;
+   }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Process-wide cache of schema catalogs
+/// Catalog is JSON Lines file, every line {"hash":"...","info":{...}} is one streamer info,
+/// hash is content hash of info JSON. Lines are only appended, therefore catalog is read
+/// incrementally - only lines, added after previous read, are parsed.
+
+class TJSONSchemaCatalogs {
+   struct Catalog {
+      Long64_t fLoaded{0};                                   // size of already parsed catalog content
+      std::unordered_map<std::string, nlohmann::json> fInfos; // hash -> streamer info
+   };
+
+   std::mutex fMutex;
+   std::unordered_map<std::string, Catalog> fCatalogs; // catalog file name -> content
+
+   static std::string MakeHash(const std::string &text)
+   {
+      char buf[20];
+      snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)jsonio::ContentHash(text.data(), text.length()));
+      return buf;
+   }
+
+   /// Parse lines, appended to catalog since previous read
+   void Update(const std::string &fname, Catalog &cat)
+   {
+      std::ifstream is(fname, std::ios::binary);
+      if (!is)
+         return;
+      is.seekg(cat.fLoaded);
+
+      std::string line;
+      while (std::getline(is, line)) {
+         // last line without newline may be written just now
+         if (is.eof())
+            break;
+         cat.fLoaded = is.tellg();
+
+         auto entry = nlohmann::json::parse(line, nullptr, false);
+         auto hash = entry.is_object() ? entry.find("hash") : entry.end();
+         auto info = entry.is_object() ? entry.find("info") : entry.end();
+         if ((hash != entry.end()) && hash->is_string() && (info != entry.end()) && info->is_object())
+            cat.fInfos.emplace(hash->get<std::string>(), std::move(*info));
+      }
+   }
+
+public:
+   static TJSONSchemaCatalogs &Instance()
+   {
+      static TJSONSchemaCatalogs catalogs;
+      return catalogs;
+   }
+
+   /// Find streamer infos with specified hashes, catalog file is read only when hash is unknown
+   Bool_t Resolve(const std::string &fname, const nlohmann::json &hashes, nlohmann::json &infos)
+   {
+      std::lock_guard<std::mutex> lock(fMutex);
+      auto &cat = fCatalogs[fname];
+
+      infos = nlohmann::json::array();
+      Bool_t updated = kFALSE;
+      for (const auto &hash : hashes) {
+         if (!hash.is_string())
+            return kFALSE;
+         auto iter = cat.fInfos.find(hash.get<std::string>());
+         if ((iter == cat.fInfos.end()) && !updated) {
+            Update(fname, cat);
+            updated = kTRUE;
+            iter = cat.fInfos.find(hash.get<std::string>());
+         }
+         if (iter == cat.fInfos.end()) {
+            ::Error("TJSONFile::LoadStreamerInfos", "Streamer info %s not found in schema catalog %s",
+                    hash.get<std::string>().c_str(), fname.c_str());
+            return kFALSE;
+         }
+         infos.push_back(iter->second);
+      }
+      return kTRUE;
+   }
+
+   /// Add streamer infos to the catalog, hashes of all infos are returned
+   /// Each new line is appended to catalog file with single write call
+   Bool_t Store(const std::string &fname, const nlohmann::json &infos, nlohmann::json &hashes)
+   {
+      std::lock_guard<std::mutex> lock(fMutex);
+      auto &cat = fCatalogs[fname];
+
+      Update(fname, cat);
+
+      int fd = -1;
+      hashes = nlohmann::json::array();
+      for (const auto &info : infos) {
+         std::string text = info.dump();
+         std::string hash = MakeHash(text);
+         auto iter = cat.fInfos.find(hash);
+         if (iter != cat.fInfos.end()) {
+            if (iter->second != info) {
+               ::Error("TJSONFile::WriteStreamerInfo", "Hash collision in schema catalog %s", fname.c_str());
+               break;
+            }
+         } else {
+            if ((fd < 0) && ((fd = ::open(fname.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644)) < 0)) {
+               ::Error("TJSONFile::WriteStreamerInfo", "Fail to open schema catalog %s", fname.c_str());
+               break;
+            }
+            std::string line = "{\"hash\":\"" + hash + "\",\"info\":" + text + "}\n";
+            if (::write(fd, line.data(), line.length()) != (ssize_t)line.length()) {
+               ::Error("TJSONFile::WriteStreamerInfo", "Fail to write schema catalog %s", fname.c_str());
+               break;
+            }
+            cat.fInfos.emplace(hash, info);
+         }
+         hashes.push_back(hash);
+      }
+
+      if (fd >= 0)
+         ::close(fd);
+
+      return hashes.size() == infos.size();
+   }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Table of JSON subtrees, which repeat in several stored objects
+/// First pass counts subtrees above size threshold, second pass replaces
+/// repeated subtrees by {"$shared":id} markers. Subtree in the table can
+/// reference smaller subtrees with lower ids.
+
+class TJSONSubtreeTable {
+   std::size_t fMinSize{0};
+   std::unordered_map<ULong64_t, Int_t> fCounts;                         // hash -> number of occurrences
+   std::unordered_map<ULong64_t, std::vector<Int_t>> fIds;               // hash -> ids in the table
+   std::vector<std::string> fTexts;                                      // original text of subtrees, to resolve hash collisions
+
+public:
+   nlohmann::json fTable = nlohmann::json::array(); ///< subtrees with markers, written to the file
+
+   TJSONSubtreeTable(std::size_t minsize) : fMinSize(minsize) {}
+
+   /// Count subtrees of the node, node itself is not counted
+   void Count(const nlohmann::json &node)
+   {
+      if (!node.is_structured())
+         return;
+      for (auto &el : node) {
+         if (!el.is_structured())
+            continue;
+         std::string text = el.dump();
+         // children are always smaller than parent
+         if (text.length() < fMinSize)
+            continue;
+         fCounts[jsonio::ContentHash(text.data(), text.length())]++;
+         Count(el);
+      }
+   }
+
+   /// Replace repeated subtrees of the node by markers
+   void Replace(nlohmann::json &node)
+   {
+      if (!node.is_structured() || fCounts.empty())
+         return;
+      for (auto &el : node) {
+         if (!el.is_structured())
+            continue;
+         std::string text = el.dump();
+         if (text.length() < fMinSize)
+            continue;
+         auto hash = jsonio::ContentHash(text.data(), text.length());
+         auto iter = fCounts.find(hash);
+         if ((iter == fCounts.end()) || (iter->second < 2)) {
+            Replace(el);
+            continue;
+         }
+
+         Int_t id = -1;
+         for (auto cand : fIds[hash])
+            if (fTexts[cand] == text)
+               id = cand;
+
+         if (id < 0) {
+            Replace(el);
+            id = fTable.size();
+            fTable.push_back(std::move(el));
+            fTexts.emplace_back(std::move(text));
+            fIds[hash].push_back(id);
+         }
+
+         el = nlohmann::json::object();
+         el[jsonio::SharedMark] = id;
+      }
+   }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Prototypes of default-constructed objects, used to suppress members with default values
+/// Prototypes are stored in the file, therefore reader does not depend on class defaults
+/// of current code version. Members are compared by their JSON text, which keeps round trip exact.
+
+class TJSONClassDefaults {
+   std::unordered_map<std::string, Bool_t> fProbed; // classes, for which prototype was created or failed
+
+   const nlohmann::json *Prototype(const std::string &clname)
+   {
+      if (!fProbed.emplace(clname, kTRUE).second)
+         return fTable.contains(clname) ? &fTable[clname] : nullptr;
+
+      TClass *cl = TClass::GetClass(clname.c_str());
+      void *obj = cl ? cl->New() : nullptr;
+      if (!obj)
+         return nullptr;
+
+      std::string text;
+      auto codec = TJSONCodec::Find(cl);
+      if (!codec || !codec->Write(text, obj))
+         text = TBufferJSON::ConvertToJSON(obj, cl).Data();
+      cl->Destructor(obj);
+
+      try {
+         fTable[clname] = nlohmann::json::parse(text);
+      } catch (nlohmann::json::exception const &) {
+         return nullptr;
+      }
+
+      return &fTable[clname];
+   }
+
+public:
+   nlohmann::json fTable = nlohmann::json::object(); ///< class name -> prototype, written to the file
+
+   /// Remove members of the node and its sub-objects, which are equal to class defaults
+   void Suppress(nlohmann::json &node)
+   {
+      if (node.is_array()) {
+         for (auto &el : node)
+            Suppress(el);
+         return;
+      }
+      if (!node.is_object())
+         return;
+
+      // columnar tree does not have TBufferJSON layout
+      auto typenode = node.find("_typename");
+      auto proto = (typenode != node.end()) && typenode->is_string() && !node.contains(jsonio::Columnar)
+                      ? Prototype(typenode->get<std::string>())
+                      : nullptr;
+
+      for (auto iter = node.begin(); iter != node.end();) {
+         const std::string &name = iter.key();
+         if (proto && (name != "_typename") && (name[0] != '$') && proto->contains(name) &&
+             ((*proto)[name].dump() == iter.value().dump())) {
+            iter = node.erase(iter);
+         } else {
+            Suppress(iter.value());
+            ++iter;
+         }
+      }
+   }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Create copy of object, TObject::Clone is used when possible
+/// Other objects are copied with normal streamer
+/// Copy does not belong to any directory - TH1::Clone() appends it to gDirectory,
+/// which is the file itself during Get()
+
+void *CloneObject(const void *obj, TClass *cl)
+{
+   if (cl->InheritsFrom(TObject::Class())) {
+      auto tobj = (const TObject *)((const char *)obj + cl->GetBaseClassOffset(TObject::Class()));
+      auto clone = tobj->Clone();
+      if (!clone)
+         return nullptr;
+      void *copy = (char *)clone - cl->GetBaseClassOffset(TObject::Class());
+      if (auto func = cl->GetDirectoryAutoAdd())
+         func(copy, nullptr);
+      return copy;
+   }
+
+   void *copy = cl->New();
+   if (!copy)
+      return nullptr;
+
+   TBufferFile buffer(TBuffer::kWrite);
+   cl->Streamer((void *)obj, buffer);
+   buffer.SetReadMode();
+   buffer.SetBufferOffset(0);
+   cl->Streamer(copy, buffer);
+
+   return copy;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Add members with default values, which were suppressed when object was written
+
+void ApplyClassDefaults(nlohmann::json &node, const nlohmann::json &table)
+{
+   if (node.is_array()) {
+      for (auto &el : node)
+         ApplyClassDefaults(el, table);
+      return;
+   }
+   if (!node.is_object())
+      return;
+
+   for (auto &el : node)
+      ApplyClassDefaults(el, table);
+
+   auto typenode = node.find("_typename");
+   if ((typenode == node.end()) || !typenode->is_string() || node.contains(jsonio::Columnar))
+      return;
+
+   auto proto = table.find(typenode->get<std::string>());
+   if (proto == table.end())
+      return;
+
+   for (auto &el : proto->items())
+      if (!node.contains(el.key()))
+         node[el.key()] = el.value();
+}
+
+} // namespace
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Open or creates local XML file with name filename.
 /// It is recommended to specify filename as "<file>.xml". The suffix ".xml"
@@ -111,12 +649,25 @@ ClassImp(TJSONFile);
 ///           = UPDATE          open an existing file for writing.
 ///                             if no file exists, it is created.
 ///           = READ            open an existing file for reading.
+///           = APPEND          open JSON Lines file for appending, file is created
+///                             if not exists. Several processes may append to the same
+///                             file simultaneously, see TJSONFile::AppendRecord().
+///                             Such file is recognized by its content when opened for
+///                             reading, use TJSONFile::CompactAppendLog() to convert it
+///                             into normal file. Normal JSON file cannot be opened for appending
 ///
 /// For more details see comments for TFile::TFile() constructor
 ///
-/// TJSONFile does not support TTree objects
+/// TTree objects are stored in columnar form, see TJSONTreeReader
+
+static constexpr int kCurrentFileFormatVersion = 2;
 
-static constexpr int kCurrentFileFormatVersion = 1;
+// files without class defaults table, shared objects, shared subtrees, delta records
+// and columnar trees are written with version 1 and remain readable by older versions
+static constexpr int kBaseFileFormatVersion = 1;
+
+// records up to this size are appended without length and hash header, see TJSONFile::AppendRecord()
+static constexpr Long64_t kPlainRecordSize = 4096;
 
 TJSONFile::TJSONFile(const char *filename, Option_t *option, const char *title, Int_t compression)
 {
@@ -149,7 +700,7 @@ TJSONFile::TJSONFile(const char *filename, Option_t *option, const char *title,
    fProcessIDs = nullptr;
    fNProcessIDs = 0;
    //fIOVersion = TJSONFile::Class_Version();
-   fIOVersion = kCurrentFileFormatVersion;
+   fIOVersion = kBaseFileFormatVersion;
    SetBit(kBinaryFile, kFALSE);
 
    fOption = option;
@@ -162,8 +713,9 @@ TJSONFile::TJSONFile(const char *filename, Option_t *option, const char *title,
    Bool_t recreate = (fOption == "RECREATE") ? kTRUE : kFALSE;
    Bool_t update = (fOption == "UPDATE") ? kTRUE : kFALSE;
    Bool_t read = (fOption == "READ") ? kTRUE : kFALSE;
+   Bool_t append = (fOption == "APPEND") ? kTRUE : kFALSE;
 
-   if (!create && !recreate && !update && !read)
+   if (!create && !recreate && !update && !read && !append)
    {
       read = kTRUE;
       fOption = "READ";
@@ -186,6 +738,7 @@ TJSONFile::TJSONFile(const char *filename, Option_t *option, const char *title,
       recreate = kFALSE;
       update = kFALSE;
       read = kFALSE;
+      append = kFALSE;
       fOption = "CREATE";
       SetBit(TFile::kDevNull);
    }
@@ -233,6 +786,12 @@ TJSONFile::TJSONFile(const char *filename, Option_t *option, const char *title,
       }
    }
 
+   if (append && !gSystem->AccessPathName(fname, kFileExists) && gSystem->AccessPathName(fname, kWritePermission))
+   {
+      Error("TJSONFile", "no write permission, could not open file %s", fname);
+      goto zombie;
+   }
+
    if (read)
    {
       if (gSystem->AccessPathName(fname, kFileExists))
@@ -249,12 +808,18 @@ TJSONFile::TJSONFile(const char *filename, Option_t *option, const char *title,
 
    fRealName = fname;
 
-   if (create || update)
+   if (create || update || append)
       SetWritable(kTRUE);
    else
       SetWritable(kFALSE);
 
-   InitJsonFile(create);
+   if (append) {
+      fAppend = kTRUE;
+      if (!OpenAppendLog())
+         goto zombie;
+   }
+
+   InitJsonFile(create || append);
 
    return;
 
@@ -311,8 +876,6 @@ void TJSONFile::InitJsonFile(Bool_t create)
 
 void TJSONFile::Close(Option_t *option)
 {
-   printf("Close %d\n", IsOpen());
-
    if (!IsOpen())
       return;
 
@@ -320,17 +883,53 @@ void TJSONFile::Close(Option_t *option)
    if (opt.Length() > 0)
       opt.ToLower();
 
-   if (IsWritable())
+   // in append mode all records are already in the file, only streamer infos are added
+   if (IsWritable() && !fAppend)
       SaveToFile();
+   else if (IsWritable())
+      AppendStreamerInfos();
 
    fWritable = kFALSE;
 
+   // keys nodes are deleted together with keys
+   fNodesLRU.clear();
+   fNodesPos.clear();
+   fMemoryUsed = 0;
+
+   fPendingKeys.clear();
+   fPendingPos.clear();
+   fPendingSize = 0;
+
+   if (fSpillFd >= 0) {
+      ::close(fSpillFd);
+      fSpillFd = -1;
+      fSpillSize = 0;
+   }
+
    if (fDoc)
    {
       delete (nlohmann::json *)fDoc;
       fDoc = nullptr;
    }
 
+   UnmapFile();
+
+   SetDeltaCache(0, nullptr);
+
+   fContentKeys.clear();
+   fSharedObjects.clear();
+
+   SetSubtrees(nullptr);
+   SetDefaults(nullptr);
+
+   EvictCachedObjects(0);
+
+   if (fD >= 0)
+   {
+      ::close(fD);
+      fD = -1;
+   }
+
    if (fClassIndex)
    {
       delete fClassIndex;
@@ -401,6 +1000,12 @@ Int_t TJSONFile::ReOpen(Option_t *mode)
    if (opt == fOption || (opt == "UPDATE" && fOption == "CREATE"))
       return 1;
 
+   if (fAppend)
+   {
+      Error("ReOpen", "file %s opened in append mode cannot be reopened", GetName());
+      return 1;
+   }
+
    if (opt == "READ")
    {
       // switch to READ mode
@@ -437,6 +1042,21 @@ TKey *TJSONFile::CreateKey(TDirectory *mother, const void *obj, const TClass *cl
    return new TKeyJSON(mother, ++fKeyCounter, obj, cl, name);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// create json key for object, which JSON was already produced elsewhere
+/// Used by TJSONBufferMerger to store objects serialized in other threads
+
+TKey *TJSONFile::CreateKey(TDirectory *mother, const char *name, const char *title, const char *classname,
+                           std::string &payload, void *objnode, Long64_t objsize)
+{
+   if (!IsWritable()) {
+      Error("CreateKey", "File %s is not writable", GetName());
+      return nullptr;
+   }
+
+   return new TKeyJSON(mother ? mother : this, ++fKeyCounter, name, title, classname, payload, objnode, objsize);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// function produces pair of xml and dtd file names
 
@@ -459,11 +1079,13 @@ void TJSONFile::ProduceFileNames(const char *filename, TString &fname)
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Saves json structures to the file
-/// jsomn elements are kept in list of TKeyJSON objects
-/// When saving, all this elements are linked to root json node
-/// At the end StreamerInfo structures are added
-/// After json document is saved, all nodes will be unlinked from root node
-/// and kept in memory.
+/// json elements are kept in list of TKeyJSON objects
+/// Each key is written as separate record in "Keys" array, at the end StreamerInfo
+/// structures and file attributes are added.
+/// For every record offset, length and content hash are collected in "KeysIndex" trailer,
+/// which allows to read single key without parsing complete document.
+/// Last member "IndexSeek" is offset of the trailer, it is located by reading the file tail.
+/// Written file remains valid JSON document.
 /// Only Close() or destructor release memory, used by json structures
 
 void TJSONFile::SaveToFile()
@@ -475,6 +1097,15 @@ void TJSONFile::SaveToFile()
    if (!fDoc)
       return;
 
+   // records, which were not yet read, must be loaded before file is overwritten
+   if (fIndexed)
+      LoadKeysNodes(this);
+   LoadSharedObjects();
+
+   // infos of the file, not used so far, are taken from the document before it is replaced
+   if (IsStoreStreamerInfos())
+      ApplyStreamerInfos(kTRUE);
+
    auto &rootNode = *((nlohmann::json *)fDoc);
 
    rootNode = nlohmann::json::object();
@@ -501,53 +1132,224 @@ void TJSONFile::SaveToFile()
    TString fname;
    ProduceFileNames(fRealName, fname);
 
-   CombineNodesTree(this, &rootNode["Keys"], kTRUE);
-
    WriteStreamerInfo();
 
+   nlohmann::json index = nlohmann::json::object();
+   index["keys"] = nlohmann::json::array();
+
+   // prototypes of classes are collected while objects are written
+   std::unique_ptr<TJSONClassDefaults> defaults;
+   if (fClassDefaults)
+      defaults = std::make_unique<TJSONClassDefaults>();
+   fDefaultsTable = defaults.get();
+
+   // find subtrees, which repeat in stored objects
+   std::unique_ptr<TJSONSubtreeTable> table;
+   if (fSubtreeSharing > 0) {
+      table = std::make_unique<TJSONSubtreeTable>(fSubtreeSharing);
+      CountSubtrees(this, table.get());
+   }
+   fSubtreeTable = table.get();
+
    // save document
    {
-      std::ofstream o(fname.Data());
-      o << std::setw(3) << rootNode << std::endl;
+      std::ofstream o(fname.Data(), std::ios::binary);
+
+      // spilled records are copied directly into output file
+      if (fSpillFd >= 0)
+         fSpliceFd = ::open(fname.Data(), O_WRONLY);
+
+      o << "{\n\"Keys\": [";
+      WriteKeysRecords(o, this, &index["keys"]);
+      o << "\n]";
+
+      if (fSpliceFd >= 0) {
+         ::close(fSpliceFd);
+         fSpliceFd = -1;
+      }
+
+      fSubtreeTable = nullptr;
+      fDefaultsTable = nullptr;
+
+      // file with class defaults, shared objects, shared subtrees, delta records or columnar trees
+      // must not be read by versions, which do not know about them
+      Bool_t extended = (defaults && !defaults->fTable.empty()) || (table && !table->fTable.empty()) ||
+                        !fSharedObjects.empty() || fDeltaStored || fColumnarStored;
+      fIOVersion = extended ? kCurrentFileFormatVersion : kBaseFileFormatVersion;
+      rootNode[jsonio::IOVersion] = fIOVersion;
+
+      if (defaults && !defaults->fTable.empty()) {
+         o << ",\n\"" << jsonio::ClassDefaults << "\": ";
+         Long64_t offset = o.tellp();
+         o << defaults->fTable.dump();
+         index["defaults"] = { offset, (Long64_t)o.tellp() - offset };
+      }
+
+      if (table && !table->fTable.empty()) {
+         o << ",\n\"" << jsonio::SharedSubtrees << "\": ";
+         Long64_t offset = o.tellp();
+         o << table->fTable.dump();
+         index["subtrees"] = { offset, (Long64_t)o.tellp() - offset };
+      }
+
+      if (!fSharedObjects.empty()) {
+         // objects, which are no longer referenced, are replaced by null to keep ids
+         std::vector<Bool_t> used(fSharedObjects.size(), kFALSE);
+         MarkSharedObjects(this, used);
+
+         o << ",\n\"" << jsonio::SharedObjects << "\": [";
+         auto &ranges = index["shared"] = nlohmann::json::array();
+         for (std::size_t id = 0; id < fSharedObjects.size(); id++) {
+            o << (id > 0 ? ",\n" : "\n");
+            Long64_t offset = o.tellp();
+            if (used[id])
+               o << fSharedObjects[id];
+            else
+               o << "null";
+            ranges.push_back({offset, used[id] ? (Long64_t)o.tellp() - offset : 0});
+         }
+         o << "\n]";
+      }
+
+      if (rootNode.contains(jsonio::SInfos)) {
+         o << ",\n\"" << jsonio::SInfos << "\": ";
+         Long64_t offset = o.tellp();
+         o << rootNode[jsonio::SInfos].dump();
+         index["sinfos"] = { offset, (Long64_t)o.tellp() - offset };
+      }
+
+      o << ",\n";
+      Long64_t indexseek = o.tellp();
+      o << "\"" << jsonio::KeysIndex << "\": " << index.dump();
+
+      for (auto &el : rootNode.items())
+         if (el.key() != jsonio::SInfos)
+            o << ",\n" << nlohmann::json(el.key()).dump() << ": " << el.value().dump();
+
+      o << ",\n\"" << jsonio::IndexSeek << "\": " << indexseek << "\n}" << std::endl;
    }
 
+   // file content was replaced, all records are loaded before
+   UnmapFile();
+   SetSubtrees(nullptr);
+   SetDefaults(nullptr);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// Connect/disconnect all file nodes to single tree before/after saving
+/// Load all keys records, which were not yet read from the file
 
-void TJSONFile::CombineNodesTree(TDirectory *dir, void *topnode, Bool_t dolink)
-{ 
-    if (!dir)
-       return;
+void TJSONFile::LoadKeysNodes(TDirectory *dir)
+{
+   TIter iter(dir->GetListOfKeys());
+   TKeyJSON *key = nullptr;
+
+   while ((key = (TKeyJSON *)iter()) != nullptr) {
+      // spilled records are copied from spill file
+      if (!key->IsSpilled())
+         key->LoadKeyNode();
+      TDirectory *subdir = key->IsSubdir() ? FindKeyDir(dir, key->GetKeyId()) : nullptr;
+      if (subdir)
+         LoadKeysNodes(subdir);
+      // offsets will not be valid after file is rewritten, keys will be taken from record
+      key->SetSubIndex(nullptr);
+   }
+}
 
-       TIter iter(dir->GetListOfKeys());
-       TKeyJSON *key = nullptr;
-       //auto &topNodeJSON = *(nlohmann::json *)topnode;
+////////////////////////////////////////////////////////////////////////////////
+/// Write records of all keys of the directory and fill keys index
+/// Subdirectory is written as record with nested "Keys" array, index entry
+/// for such record gets nested "keys" index
 
-       nlohmann::json infos_array = nlohmann::json::array();
+void TJSONFile::WriteKeysRecords(std::ostream &os, TDirectory *dir, void *indexnode)
+{
+   if (!dir)
+      return;
 
-       while ((key = (TKeyJSON *)iter()) != nullptr) {
-         nlohmann::json topNodeJSON = nlohmann::json::object();
-          if (dolink){
-            
-            topNodeJSON = *(nlohmann::json *)key->KeyNode(); 
-          }
-         // else
-             //fXML->UnlinkNode(key->KeyNode());
-          if (key->IsSubdir())
-             CombineNodesTree(FindKeyDir(dir, key->GetKeyId()), key->KeyNode(), dolink);
+   auto &index = *((nlohmann::json *)indexnode);
+
+   TIter iter(dir->GetListOfKeys());
+   TKeyJSON *key = nullptr;
+   Bool_t first = kTRUE;
+
+   while ((key = (TKeyJSON *)iter()) != nullptr) {
+      // record of spilled key is read only when it should be modified, huge records are never parsed
+      Bool_t reduce = (fSubtreeTable || fDefaultsTable) && !(key->IsSpilled() && IsHugeRecord(key->fSpillLength));
+      nlohmann::json spillnode;
+      if (key->IsSpilled() && reduce && !ReadSpilledNode(key, &spillnode))
+         continue;
+      if (!key->KeyNode() && !key->IsSpilled())
+         continue;
+
+      auto &node = key->KeyNode() ? *((nlohmann::json *)key->KeyNode()) : spillnode;
+
+      // record may come from file, which was opened for update
+      if (node.contains(jsonio::Delta))
+         fDeltaStored = kTRUE;
+      auto objnode = node.find(jsonio::Object);
+      if ((objnode != node.end()) && objnode->is_object() && objnode->contains(jsonio::Columnar))
+         fColumnarStored = kTRUE;
+
+      os << (first ? "\n" : ",\n");
+      first = kFALSE;
+
+      nlohmann::json entry = nlohmann::json::object();
+      entry[jsonio::Name] = key->GetName();
+      if (strlen(key->GetTitle()) > 0)
+         entry[jsonio::Title] = key->GetTitle();
+      entry[jsonio::Cycle] = key->GetCycle();
+      entry[jsonio::ObjClass] = key->GetClassName();
+      if (node.contains(jsonio::CreateTm))
+         entry[jsonio::CreateTm] = node[jsonio::CreateTm];
+      else if (key->IsSpilled())
+         entry[jsonio::CreateTm] = TestBit(TFile::kReproducible) ? TDatime((UInt_t)1).AsSQLString() : key->GetDatime().AsSQLString();
+
+      Long64_t offset = os.tellp();
+
+      TDirectory *subdir = key->IsSubdir() ? FindKeyDir(dir, key->GetKeyId()) : nullptr;
+
+      if (subdir) {
+         nlohmann::json attr = node;
+         attr.erase("Keys");
+         std::string rec = attr.dump();
+         rec.pop_back(); // closing brace, keys records follow
+         os << rec << ",\"Keys\":[";
+         entry["keys"] = nlohmann::json::array();
+         WriteKeysRecords(os, subdir, &entry["keys"]);
+         os << "\n]}";
+      } else if (key->IsSpilled() && !reduce) {
+         // record already has final form
+         if (!CopySpilledRecord(os, key->fSpillOffset, key->fSpillLength))
+            Error("WriteKeysRecords", "Fail to copy spilled record of key %s;%d", key->GetName(), key->GetCycle());
+         entry["hash"] = TString::Format("%016llx", (unsigned long long)key->fSpillHash).Data();
+      } else {
+         std::string rec;
+         if (reduce) {
+            // object is written in reduced form, key itself is not changed
+            nlohmann::json recnode = node, obj;
+            if (GetStoredObject(key, &obj)) {
+               if (fSubtreeTable)
+                  ((TJSONSubtreeTable *)fSubtreeTable)->Replace(obj);
+               recnode[jsonio::Object] = std::move(obj);
+            }
+            rec = recnode.dump();
+         } else {
+            key->WriteRecord(rec);
+         }
+         os << rec;
+         entry["hash"] = TString::Format("%016llx", (unsigned long long)jsonio::ContentHash(rec.data(), rec.length())).Data();
+      }
 
-         infos_array.push_back(topNodeJSON);
-       }
+      entry["offset"] = offset;
+      entry["length"] = (Long64_t)os.tellp() - offset;
 
-        (*((nlohmann::json *)topnode))= infos_array;
-    
+      index.push_back(entry);
+   }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 /// read document from file
-/// Now full content of document reads into the memory
+/// If file has keys index trailer, only trailer is read and keys records
+/// are read on demand. Otherwise full content of document reads into the memory
 /// Then document decomposed to separate keys and streamer info structures
 /// All irrelevant data will be cleaned
 
@@ -555,6 +1357,16 @@ Bool_t TJSONFile::ReadFromFile()
 {
    assert(!fDoc && "Expect fDoc == nullptr!");
 
+   fD = ::open(fRealName.Data(), O_RDONLY);
+
+   if ((fD >= 0) && IsAppendLog()) {
+      MapFile();
+      return ReadAppendLog();
+   }
+
+   if ((fD >= 0) && MapFile() && (ReadIndexTrailer() || ScanKeysRecords()))
+      return kTRUE;
+
    std::ifstream file(fRealName.Data());
    if (file.good())
    {
@@ -567,44 +1379,18 @@ Bool_t TJSONFile::ReadFromFile()
          throw std::runtime_error(e.what());
       }
       auto &rootNode = *((nlohmann::json *)fDoc);
-      if (!rootNode.contains(jsonio::Type))
-         throw std::runtime_error("File does not have a type.");
-      else if (rootNode[jsonio::Type] != "ROOTfile")
-         throw std::runtime_error("Not a ROOT File.");
-      else if (rootNode[jsonio::IOVersion] > kCurrentFileFormatVersion)
-         throw std::runtime_error("File version not compatible.");
-      else
-      {
-         TString fType = rootNode[jsonio::Type].get<std::string>();
-         long int versionOfROOT = rootNode["ROOTVersionCode"].get<long int>();
-         fIOVersion = rootNode[jsonio::IOVersion].get<int>();
-
-         if (rootNode.contains(jsonio::CreateTm))
-         {
-            TDatime tm(rootNode[jsonio::CreateTm].get<std::string>().c_str());
-            fDatimeC = tm;
-         }
-         if (rootNode.contains(jsonio::ModifyTm))
-         {
-            TDatime tm(rootNode[jsonio::ModifyTm].get<std::string>().c_str());
-            fDatimeM = tm;
-         }
-         if (rootNode.contains(jsonio::ObjectUUID))
-            fUUID = rootNode[jsonio::ObjectUUID].get<std::string>().c_str();
 
-         if (rootNode.contains(jsonio::Title))
-            SetTitle(rootNode[jsonio::Title].get<std::string>().c_str());
+      ReadFileHeader(&rootNode);
 
-         //////////////////////////////////////////////////////////////
+      // streamer infos applied when first object is read
+      fSInfosPending = rootNode.contains(jsonio::SInfos) || rootNode.contains(jsonio::SchemaHashes);
 
-         if (rootNode.contains("StreamerInfos"))
-            ReadStreamerInfo();
+      if (rootNode.contains(jsonio::SharedSubtrees) || rootNode.contains(jsonio::ClassDefaults))
+         ExpandObject(&rootNode["Keys"]);
 
-          ReadKeysList(this, &rootNode);
-         std::cout << fType << "  " << fUUID.AsString() << std::endl;
+      ReadKeysList(this, &rootNode);
 
-         return kTRUE;
-      }
+      return kTRUE;
    }
    else
       throw std::runtime_error("File does not exist.");
@@ -612,284 +1398,1607 @@ Bool_t TJSONFile::ReadFromFile()
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// Read list of keys for directory
+/// Check file type and version, read file attributes from top node
 
-Int_t TJSONFile::ReadKeysList(TDirectory *dir, void *topnode)
+void TJSONFile::ReadFileHeader(void *rootnode)
 {
-   if (!dir || !topnode)
-      return 0;
-         Int_t nkeys = 0;
-         auto &rootnode = *((nlohmann::json *)topnode);
-         auto &keynode = rootnode["Keys"];
+   auto &rootNode = *((nlohmann::json *)rootnode);
 
-         TList *list = new TList();
+   if (!rootNode.contains(jsonio::Type))
+      throw std::runtime_error("File does not have a type.");
+   else if (rootNode[jsonio::Type] != "ROOTfile")
+      throw std::runtime_error("Not a ROOT File.");
+   else if (rootNode[jsonio::IOVersion] > kCurrentFileFormatVersion)
+      throw std::runtime_error("File version not compatible.");
 
-         while (keynode[nkeys].contains("Object")) {
+   fIOVersion = rootNode[jsonio::IOVersion].get<int>();
 
-               TKeyJSON *key = new TKeyJSON(dir, ++fKeyCounter, &keynode[nkeys]);
-               dir->AppendKey(key);
-               //if (gDebug > 0)
-                 // Info("ReadKeysList", "Add key %s from node %s", key->GetName(), fXML->GetNodeName(keynode));
+   if (rootNode.contains(jsonio::CreateTm))
+   {
+      TDatime tm(rootNode[jsonio::CreateTm].get<std::string>().c_str());
+      fDatimeC = tm;
+   }
+   if (rootNode.contains(jsonio::ModifyTm))
+   {
+      TDatime tm(rootNode[jsonio::ModifyTm].get<std::string>().c_str());
+      fDatimeM = tm;
+   }
+   if (rootNode.contains(jsonio::ObjectUUID))
+      fUUID = rootNode[jsonio::ObjectUUID].get<std::string>().c_str();
 
-               nkeys++;
-         }
+   if (rootNode.contains(jsonio::Title))
+      SetTitle(rootNode[jsonio::Title].get<std::string>().c_str());
 
-         return nkeys;
-      
+   // when file is updated, infos are written into same catalog
+   if (rootNode.contains(jsonio::SchemaCatalog))
+      fSchemaCatalog = rootNode[jsonio::SchemaCatalog].get<std::string>();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// convert all TStreamerInfo, used in file, to xml format
+/// Try to read keys index from the file trailer
+/// Offset of the trailer is value of last "IndexSeek" member in the document.
+/// Trailer with file attributes is parsed as separate object, key records are
+/// not touched. Returns kFALSE if file does not have trailer.
 
-void TJSONFile::WriteStreamerInfo()
+Bool_t TJSONFile::ReadIndexTrailer()
 {
+   struct stat sbuf;
+   if (fstat(fD, &sbuf) != 0)
+      return kFALSE;
 
-   if (!IsStoreStreamerInfos())
-      return;
+   Long64_t size = sbuf.st_size;
+   Long64_t tailsize = size < 128 ? size : 128;
 
-   TObjArray list;
+   std::string buf;
+   if (!ReadRecord(size - tailsize, tailsize, buf))
+      return kFALSE;
 
-   TIter iter(gROOT->GetListOfStreamerInfo());
+   std::string tag = std::string("\"") + jsonio::IndexSeek + "\":";
+   auto pos = buf.rfind(tag);
+   if (pos == std::string::npos)
+      return kFALSE;
 
-   TStreamerInfo *info = nullptr;
+   Long64_t seek = std::strtoll(buf.c_str() + pos + tag.length(), nullptr, 10);
+   if ((seek <= 0) || (seek >= size))
+      return kFALSE;
 
-   while ((info = (TStreamerInfo *)iter()) != nullptr)
-   {
-      Int_t uid = info->GetNumber();
-      if (fClassIndex->fArray[uid] || true) // just for debugging add all existing streamer infos
-         list.Add(info);
+   if (!ReadRecord(seek, size - seek, buf))
+      return kFALSE;
+
+   // trailer is the tail of top-level object
+   buf.insert(0, 1, '{');
+
+   std::unique_ptr<nlohmann::json> doc;
+   try {
+      doc = std::make_unique<nlohmann::json>(nlohmann::json::parse(buf));
+   } catch (nlohmann::detail::parse_error const &) {
+      return kFALSE;
    }
 
-   if (list.GetSize() == 0)
-      return;
+   if (!doc->contains(jsonio::KeysIndex))
+      return kFALSE;
 
-   nlohmann::json infos_array = nlohmann::json::array();
+   fDoc = doc.release();
+   auto &rootNode = *((nlohmann::json *)fDoc);
 
-   for (int n = 0; n <= list.GetLast(); n++)
-   {
-      info = (TStreamerInfo *)list.At(n);
+   ReadFileHeader(&rootNode);
 
-      nlohmann::json infonode = nlohmann::json::object();
+   fIndexed = kTRUE;
 
-      infonode["name"] = info->GetName();
-      infonode["title"] = info->GetTitle();
-      infonode["classversion"] = info->GetClassVersion();
-      infonode["checksum"] = info->GetCheckSum();
-      infonode["canoptimize"]=(info->TestBit(TStreamerInfo::kCannotOptimize) ? jsonio::False : jsonio::True);
+   auto &index = rootNode[jsonio::KeysIndex];
 
-      TIter iter2(info->GetElements());
-      infonode["elements"] = nlohmann::json::array();
+   fSInfosPending = index.contains("sinfos") || rootNode.contains(jsonio::SchemaHashes);
 
-      TStreamerElement *elem = nullptr;
+   ReadKeysIndex(this, &index["keys"]);
+
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Scan file without keys index with SAX parser
+/// Only file attributes, keys attributes and byte ranges of keys records are collected,
+/// objects are not parsed. Produced index used same way as trailer index,
+/// keys records are read on demand. Returns kFALSE if file is not mapped into memory.
+
+Bool_t TJSONFile::ScanKeysRecords()
+{
+   if (!fMapBuf)
+      return kFALSE;
+
+   Long64_t size = fMapSize;
+
+   ::madvise((void *)fMapBuf, size, MADV_SEQUENTIAL);
+
+   const char *begin = fMapBuf, *pos = begin;
+
+   TJSONKeysScanner scanner(begin, pos);
+
+   Bool_t res = nlohmann::json::sax_parse(TJSONScanIter(begin, &pos), TJSONScanIter(begin + size, &pos), &scanner);
+
+   ::madvise((void *)fMapBuf, size, MADV_RANDOM);
+
+   if (!res)
+      throw std::runtime_error(scanner.fError);
+
+   fBytesRead += size;
+
+   fDoc = new nlohmann::json(std::move(scanner.fResult));
+   auto &rootNode = *((nlohmann::json *)fDoc);
+
+   ReadFileHeader(&rootNode);
+
+   fIndexed = kTRUE;
+
+   auto &index = rootNode[jsonio::KeysIndex];
+
+   fSInfosPending = index.contains("sinfos") || rootNode.contains(jsonio::SchemaHashes);
+
+   if (index.contains("keys"))
+      ReadKeysIndex(this, &index["keys"]);
+
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Map file content into memory
+/// Keys records are accessed directly in mapped buffer without copying
+
+Bool_t TJSONFile::MapFile()
+{
+   struct stat sbuf;
+   if ((fD < 0) || (fstat(fD, &sbuf) != 0) || (sbuf.st_size == 0))
+      return kFALSE;
+
+   void *map = ::mmap(nullptr, sbuf.st_size, PROT_READ, MAP_PRIVATE, fD, 0);
+   if (map == MAP_FAILED)
+      return kFALSE;
+
+   fMapBuf = (const char *)map;
+   fMapSize = sbuf.st_size;
+
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Release mapped file content
+
+void TJSONFile::UnmapFile()
+{
+   if (fMapBuf)
+      ::munmap((void *)fMapBuf, fMapSize);
+   fMapBuf = nullptr;
+   fMapSize = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Provide view on the portion of the file
+/// If file is mapped, view points into mapped buffer, otherwise data read into buf
+
+Bool_t TJSONFile::GetRecordView(Long64_t offset, Long64_t length, std::string_view &view, std::string &buf)
+{
+   if (fMapBuf && (offset >= 0) && (length > 0) && (offset + length <= fMapSize)) {
+      view = std::string_view(fMapBuf + offset, length);
+      CountBytesRead(length);
+      return kTRUE;
+   }
+
+   if (!ReadRecord(offset, length, buf))
+      return kFALSE;
+
+   view = buf;
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read portion of the file, used to read single key record
+
+Bool_t TJSONFile::ReadRecord(Long64_t offset, Long64_t length, std::string &buf)
+{
+   if (fMapBuf && (offset >= 0) && (length > 0) && (offset + length <= fMapSize)) {
+      buf.assign(fMapBuf + offset, length);
+      CountBytesRead(length);
+      return kTRUE;
+   }
+
+   if ((fD < 0) || (offset < 0) || (length <= 0))
+      return kFALSE;
+
+   buf.resize(length);
+
+   Long64_t pos = 0;
+   while (pos < length) {
+      ssize_t n = ::pread(fD, &buf[pos], length - pos, offset + pos);
+      if (n <= 0) {
+         Error("ReadRecord", "Fail to read %lld bytes at offset %lld", length, offset);
+         return kFALSE;
+      }
+      pos += n;
+   }
+
+   CountBytesRead(length);
+
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read list of keys for directory
+/// Every key record is moved out of the "Keys" array into own node, owned by the key.
+/// Therefore addresses of keys nodes do not depend on parent document, which can be
+/// modified or released, and memory of record is released when key is deleted.
+/// Array itself is removed from parent node afterwards
+
+Int_t TJSONFile::ReadKeysList(TDirectory *dir, void *topnode)
+{
+   if (!dir || !topnode)
+      return 0;
+
+   auto &parent = *((nlohmann::json *)topnode);
+   auto iter = parent.find("Keys");
+   if ((iter == parent.end()) || !iter->is_array())
+      return 0;
+
+   Int_t nkeys = 0;
+
+   for (auto &record : *iter) {
+      if (!record.is_object() ||
+          !(record.contains(jsonio::Object) || record.contains(jsonio::Delta) || record.contains(jsonio::Shared)))
+         continue;
+
+      TKeyJSON *key = new TKeyJSON(dir, ++fKeyCounter, new nlohmann::json(std::move(record)));
+      dir->AppendKey(key);
+      nkeys++;
+   }
+
+   // only moved-out records remain in the array
+   parent.erase(iter);
+
+   return nkeys;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Create keys for directory from keys index
+/// Keys records are not read, only attributes from index entries are used
+
+Int_t TJSONFile::ReadKeysIndex(TDirectory *dir, void *indexnode)
+{
+   if (!dir || !indexnode)
+      return 0;
+
+   const auto &index = *((const nlohmann::json *)indexnode);
+
+   Int_t nkeys = 0;
+
+   for (const auto &entry : index) {
+      std::string name = entry.value(jsonio::Name, "");
+      std::string title = entry.value(jsonio::Title, "");
+      std::string clname = entry.value(jsonio::ObjClass, "");
+      std::string created = entry.value(jsonio::CreateTm, "");
+
+      TKeyJSON *key = new TKeyJSON(dir, ++fKeyCounter, name.c_str(), title.c_str(), clname.c_str(), created.c_str(),
+                                   entry.value(jsonio::Cycle, 1), entry.value("offset", (Long64_t)0),
+                                   entry.value("length", (Long64_t)0));
+
+      if (entry.contains("hash"))
+         key->SetRecordHash(std::stoull(entry["hash"].get<std::string>(), nullptr, 16));
+
+      if (entry.contains("keys"))
+         key->SetSubIndex(&entry["keys"]);
+
+      dir->AppendKey(key);
+
+      nkeys++;
+   }
+
+   return nkeys;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read streamer infos node, when keys index is used
+/// Node location is specified in the index
+
+Bool_t TJSONFile::LoadStreamerInfos()
+{
+   auto &rootNode = *((nlohmann::json *)fDoc);
+
+   // infos stored in schema catalog, only hashes are in the file
+   // append log may have both kinds of infos, written by different writers
+   auto hashes = rootNode.find(jsonio::SchemaHashes);
+   if ((hashes != rootNode.end()) && hashes->is_array()) {
+      std::string catalog = rootNode.value(jsonio::SchemaCatalog, "");
+      nlohmann::json infos;
+      if (catalog.empty() ||
+          !TJSONSchemaCatalogs::Instance().Resolve(GetSchemaCatalogPath(catalog.c_str()).Data(), *hashes, infos))
+         return kFALSE;
+      rootNode.erase(hashes);
+      auto &dest = rootNode[jsonio::SInfos];
+      if (!dest.is_array())
+         dest = nlohmann::json::array();
+      for (auto &info : infos)
+         dest.push_back(std::move(info));
+      return kTRUE;
+   }
+
+   if (rootNode.contains(jsonio::SInfos))
+      return kTRUE;
+
+   auto index = rootNode.find(jsonio::KeysIndex);
+   if (!fIndexed || (index == rootNode.end()) || !index->contains("sinfos"))
+      return kFALSE;
+
+   const auto &range = index->at("sinfos");
+
+   std::string buf;
+   if (!ReadRecord(range[0].get<Long64_t>(), range[1].get<Long64_t>(), buf))
+      return kFALSE;
+
+   try {
+      rootNode[jsonio::SInfos] = nlohmann::json::parse(buf);
+   } catch (nlohmann::detail::parse_error const &e) {
+      Error("LoadStreamerInfos", "Fail to parse streamer infos: %s", e.what());
+      return kFALSE;
+   }
+
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Apply streamer infos of the file, deferred when file was opened
+/// When all is not set, only infos of classes, which version or checksum differ from
+/// loaded dictionary, are reconstructed - other classes are read with dictionary schema.
+/// Rest of infos is applied later when all is set, for instance before file is written
+
+void TJSONFile::ApplyStreamerInfos(Bool_t all)
+{
+   auto lock = LockConcurrent();
+
+   if (!fSInfosPending && !(all && fSInfosPartial))
+      return;
+
+   if (all)
+      fSInfosFilter = fSInfosPending ? kSInfosAll : kSInfosSame;
+   else
+      fSInfosFilter = kSInfosDiffer;
+
+   fSInfosPending = kFALSE;
+   fSInfosPartial = !all;
+
+   ReadStreamerInfo();
+
+   fSInfosFilter = kSInfosAll;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// convert all TStreamerInfo, used in file, to xml format
+
+void TJSONFile::WriteStreamerInfo()
+{
+
+   if (!IsStoreStreamerInfos())
+      return;
+
+   // infos of the file, not used so far, should be written back
+   ApplyStreamerInfos(kTRUE);
+
+   TObjArray list;
+
+   TIter iter(gROOT->GetListOfStreamerInfo());
+
+   TStreamerInfo *info = nullptr;
+
+   while ((info = (TStreamerInfo *)iter()) != nullptr)
+   {
+      Int_t uid = info->GetNumber();
+      if (fClassIndex->fArray[uid] || true) // just for debugging add all existing streamer infos
+         list.Add(info);
+   }
+
+   if (list.GetSize() == 0)
+      return;
+
+   nlohmann::json infos_array = nlohmann::json::array();
+
+   for (int n = 0; n <= list.GetLast(); n++)
+   {
+      info = (TStreamerInfo *)list.At(n);
+
+      nlohmann::json infonode = nlohmann::json::object();
+
+      infonode["name"] = info->GetName();
+      infonode["title"] = info->GetTitle();
+      infonode["classversion"] = info->GetClassVersion();
+      infonode["checksum"] = info->GetCheckSum();
+      infonode["canoptimize"]=(info->TestBit(TStreamerInfo::kCannotOptimize) ? jsonio::False : jsonio::True);
+
+      TIter iter2(info->GetElements());
+      infonode["elements"] = nlohmann::json::array();
+
+      TStreamerElement *elem = nullptr;
       while ((elem = (TStreamerElement *)iter2()) != nullptr)
          StoreStreamerElement(&infonode, elem);
 
       infos_array.push_back(infonode);
    }
 
-   (*((nlohmann::json *)fDoc))["StreamerInfos"] = infos_array;
+   auto &rootNode = *((nlohmann::json *)fDoc);
+
+   // only hashes are stored when infos are written into catalog, otherwise infos stored in the file
+   nlohmann::json hashes;
+   if (!fSchemaCatalog.empty() &&
+       TJSONSchemaCatalogs::Instance().Store(GetSchemaCatalogPath(fSchemaCatalog.c_str()).Data(), infos_array, hashes)) {
+      rootNode[jsonio::SchemaCatalog] = fSchemaCatalog;
+      rootNode[jsonio::SchemaHashes] = std::move(hashes);
+   } else {
+      rootNode[jsonio::SInfos] = std::move(infos_array);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read streamerinfo structures from json format and provide them in the list
+/// It is user responsibility to destroy this list
+
+TFile::InfoListRet TJSONFile::GetStreamerInfoListImpl(bool /* lookupSICache */)
+{
+   ROOT::Internal::RConcurrentHashColl::HashValue hash;
+
+   auto lock = LockConcurrent();
+
+   TList *list = new TList();
+   list->SetOwner();
+
+   if (!fDoc || !LoadStreamerInfos())
+      return {list, 0, hash};
+
+   // document is only read, missing members must not be created
+   const auto &rootNode = *((const nlohmann::json *)fDoc);
+   auto sinfos = rootNode.find(jsonio::SInfos);
+   if ((sinfos == rootNode.end()) || !sinfos->is_array())
+      return {list, 0, hash};
+
+   for (const auto &sinfonode : *sinfos) {
+      if (!sinfonode.is_object() || !sinfonode.contains("name"))
+         continue;
+
+      TString fname = sinfonode.value("name", "");
+      TString ftitle = sinfonode.value("title", "");
+      UInt_t checksum = sinfonode.value("checksum", (UInt_t)0);
+
+      if (fSInfosFilter != kSInfosAll) {
+         TClass *cl = TClass::GetClass(fname);
+         Bool_t same = cl && cl->IsLoaded() && (cl->GetClassVersion() == sinfonode.value("classversion", 0)) &&
+                       (cl->GetCheckSum() == checksum);
+         if (same != (fSInfosFilter == kSInfosSame))
+            continue;
+      }
+
+      TStreamerInfo *info = new TStreamerInfo(TClass::GetClass(fname));
+      info->SetTitle(ftitle);
+
+      list->Add(info);
+
+      Int_t clversion = sinfonode.value("classversion", 0);
+      info->SetClassVersion(clversion);
+      info->SetOnFileClassVersion(clversion);
+      info->SetCheckSum(checksum);
+
+      if (sinfonode.value("canoptimize", std::string(jsonio::False)) == jsonio::False)
+         info->SetBit(TStreamerInfo::kCannotOptimize);
+      else
+         info->ResetBit(TStreamerInfo::kCannotOptimize);
+
+      auto elements = sinfonode.find("elements");
+      if ((elements == sinfonode.end()) || !elements->is_array())
+         continue;
+
+      for (const auto &elemnode : *elements)
+         if (elemnode.is_object() && elemnode.contains("name"))
+            ReadStreamerElement(&elemnode, info);
+   }
+
+   return {list, 0, hash};
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// store data of single TStreamerElement in streamer node
+
+void TJSONFile::StoreStreamerElement(void *infonode, TStreamerElement *elem)
+{
+
+   TClass *cl = elem->IsA();
+   nlohmann::json info = nlohmann::json::object();
+
+   char sbuf[100], namebuf[100];
+
+   info["streamerelement"] = cl->GetName(); 
+
+   info["name"] = elem->GetName();
+
+   if (strlen(elem->GetTitle()) > 0)
+      info["title"] = elem->GetTitle();
+
+   info["v"] = cl->GetClassVersion();
+
+   info["type"] = elem->GetType();
+
+   if (strlen(elem->GetTypeName()) > 0)
+      info["typename"] = elem->GetTypeName();
+
+   info["size"] = elem->GetSize();
+
+   if (elem->GetArrayDim() > 0)
+   {
+      nlohmann::json arraydim = nlohmann::json::array();
+
+      for (int ndim = 0; ndim < elem->GetArrayDim(); ndim++) {
+         arraydim.push_back(elem->GetMaxIndex(ndim));
+      }
+
+      info["arraydim"] = arraydim;
+
+   }
+   if (cl == TStreamerBase::Class())
+   {
+      TStreamerBase *base = (TStreamerBase *)elem;
+      info["baseversion"] = base->GetBaseVersion();
+      info["basechecksum"] = base->GetBaseCheckSum();
+   }
+   else if (cl == TStreamerBasicPointer::Class())
+   {
+      TStreamerBasicPointer *bptr = (TStreamerBasicPointer *)elem;
+      info["countversion"] = bptr->GetCountVersion();
+      info["countname"] = bptr->GetCountName();
+      info["countclass"] = bptr->GetCountClass();
+   }
+   else if (cl == TStreamerLoop::Class())
+   {
+      TStreamerLoop *loop = (TStreamerLoop *)elem;
+      info["countversion"] = loop->GetCountVersion();
+      info["countname"] = loop->GetCountName();
+      info["countclass"] = loop->GetCountClass();
+   }
+   else if ((cl == TStreamerSTL::Class()) || (cl == TStreamerSTLstring::Class()))
+   {
+      TStreamerSTL *stl = (TStreamerSTL *)elem;
+      info["STLtype"] = stl->GetSTLtype();
+      info["Ctype"] = stl->GetCtype();
+   }
+
+   (*((nlohmann::json *)infonode))["elements"].push_back(info);
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// read and reconstruct single TStreamerElement from json node
+
+void TJSONFile::ReadStreamerElement(const void *node, TStreamerInfo *info)
+{
+   const auto &streamernode = *((const nlohmann::json *)node);
+
+   TClass *cl = TClass::GetClass(streamernode.value("streamerelement", "").c_str());
+   if (!cl || !cl->InheritsFrom(TStreamerElement::Class()))
+      return;
+   TStreamerElement *elem = (TStreamerElement *)cl->New();
+
+   Int_t elem_type = streamernode.value("type", 0);
+
+   // title and typename are stored only when not empty
+   elem->SetName(streamernode.value("name", "").c_str());
+   elem->SetTitle(streamernode.value("title", "").c_str());
+   elem->SetType(elem_type);
+   elem->SetTypeName(streamernode.value("typename", "").c_str());
+   elem->SetSize(streamernode.value("size", 0));
+
+   if (cl == TStreamerBase::Class()) {
+      ((TStreamerBase *)elem)->SetBaseVersion(streamernode.value("baseversion", 0));
+      ((TStreamerBase *)elem)->SetBaseCheckSum(streamernode.value("basechecksum", (UInt_t)0));
+   } else if (cl == TStreamerBasicPointer::Class()) {
+      ((TStreamerBasicPointer *)elem)->SetCountVersion(streamernode.value("countversion", 0));
+      ((TStreamerBasicPointer *)elem)->SetCountName(streamernode.value("countname", "").c_str());
+      ((TStreamerBasicPointer *)elem)->SetCountClass(streamernode.value("countclass", "").c_str());
+   } else if (cl == TStreamerLoop::Class()) {
+      ((TStreamerLoop *)elem)->SetCountVersion(streamernode.value("countversion", 0));
+      ((TStreamerLoop *)elem)->SetCountName(streamernode.value("countname", "").c_str());
+      ((TStreamerLoop *)elem)->SetCountClass(streamernode.value("countclass", "").c_str());
+   } else if ((cl == TStreamerSTL::Class()) || (cl == TStreamerSTLstring::Class())) {
+      ((TStreamerSTL *)elem)->SetSTLtype(streamernode.value("STLtype", 0));
+      ((TStreamerSTL *)elem)->SetCtype(streamernode.value("Ctype", 0));
+   }
+
+   // array dimensions are written as "arraydim" array, older files have "numdim" and "dimN" members
+   auto arraydim = streamernode.find("arraydim");
+   if ((arraydim != streamernode.end()) && arraydim->is_array()) {
+      elem->SetArrayDim(arraydim->size());
+      for (std::size_t ndim = 0; ndim < arraydim->size(); ndim++)
+         elem->SetMaxIndex(ndim, (*arraydim)[ndim].get<int>());
+   } else if (streamernode.contains("numdim")) {
+      char namebuf[100];
+      Int_t numdim = streamernode.value("numdim", 0);
+      elem->SetArrayDim(numdim);
+      for (Int_t ndim = 0; ndim < numdim; ndim++) {
+         snprintf(namebuf, sizeof(namebuf), "dim%d", ndim);
+         elem->SetMaxIndex(ndim, streamernode.value(namebuf, 0));
+      }
+   }
+
+   elem->SetType(elem_type);
+   elem->SetNewType(elem_type);
+
+   info->GetElements()->Add(elem);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// If true, all correspondent to file TStreamerInfo objects will be stored in file
+/// this allows to apply schema evolution later for this file
+/// may be useful, when file used outside ROOT and TStreamerInfo objects does not required
+/// Can be changed only for newly created file.
+
+void TJSONFile::SetStoreStreamerInfos(Bool_t store)
+{
+   if (IsWritable() && (GetListOfKeys()->GetSize() == 0))
+      fStoreStreamerInfos = store;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Set encoding of TTree columns, see jsonio::EColumnEncoding
+/// With jsonio::kColumnsJSON values stored as JSON arrays and remain human-readable
+/// With jsonio::kColumnsBase64 values stored packed in base64 and compressed
+/// according to file compression settings
+
+void TJSONFile::SetColumnEncoding(Int_t encoding)
+{
+   if (IsWritable())
+      fColumnEncoding = encoding;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Enable delta encoding of cycles
+/// New cycle of existing key stored as JSON patch against previous cycle,
+/// if such patch is smaller than complete object. Every keyframe-th cycle
+/// in the chain is stored complete, which limits reconstruction costs.
+/// 0 disables delta encoding (default). File with delta records is written with
+/// current format version and cannot be read by versions, which do not know about them
+
+void TJSONFile::SetDeltaCycles(Int_t keyframe)
+{
+   // records in append mode must not depend on each other
+   if (IsWritable() && !fAppend)
+      fDeltaCycles = keyframe > 0 ? keyframe : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Enable or disable deduplication of stored objects (disabled by default)
+/// JSON of every stored object is hashed, identical objects are written only once
+/// in "SharedObjects" array and referenced from keys records.
+/// File with shared objects is written with current format version and cannot be read
+/// by versions, which do not know about such references
+
+void TJSONFile::SetDeduplicate(Bool_t on)
+{
+   if (IsWritable() && !fAppend)
+      fDeduplicate = on;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Register object JSON of the key
+/// If identical object was stored before, returns id of shared object, which should be
+/// referenced by the key. First key with such content is converted to shared reference as well.
+/// Returns -1 if object is new
+
+Int_t TJSONFile::ShareObject(TKeyJSON *key, ULong64_t hash, const std::string &text)
+{
+   auto iter = fContentKeys.find(hash);
+   if (iter == fContentKeys.end()) {
+      fContentKeys.emplace(hash, std::make_pair(key, -1));
+      return -1;
+   }
+
+   auto &entry = iter->second;
+
+   if (entry.second >= 0)
+      return fSharedObjects[entry.second] == text ? entry.second : -1;
+
+   // second object with same content, move object of first key into shared table
+   TKeyJSON *first = entry.first;
+   std::string_view view;
+   std::string buf;
+   if (!first || (first == key) || !first->GetObjectView(view, buf) || (view != text))
+      return -1;
+
+   // ids of shared objects, already stored in the file, must be preserved
+   if (fSharedObjects.empty())
+      LoadSharedObjects();
+
+   fSharedObjects.emplace_back(text);
+   entry.second = fSharedObjects.size() - 1;
+   first->SetSharedObject(entry.second);
+
+   return entry.second;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Remove key from content registry, called when key object is changed or deleted
+
+void TJSONFile::ReleaseContent(TKeyJSON *key, ULong64_t hash)
+{
+   auto iter = fContentKeys.find(hash);
+   if ((iter == fContentKeys.end()) || (iter->second.first != key))
+      return;
+
+   if (iter->second.second < 0)
+      fContentKeys.erase(iter);
+   else
+      iter->second.first = nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Provide view on JSON of shared object
+/// Object is taken from shared table, from file using offsets from keys index
+/// or from complete document
+
+Bool_t TJSONFile::GetSharedView(Int_t id, std::string_view &view, std::string &buf)
+{
+   if (id < 0)
+      return kFALSE;
+
+   if ((id < (Int_t)fSharedObjects.size()) && !fSharedObjects[id].empty()) {
+      view = fSharedObjects[id];
+      return kTRUE;
+   }
+
+   if (!fDoc)
+      return kFALSE;
+
+   // only const access, method is used by concurrent readers
+   const auto &rootNode = *((const nlohmann::json *)fDoc);
+
+   auto index = rootNode.find(jsonio::KeysIndex);
+   if (fIndexed && (index != rootNode.end()) && index->contains("shared")) {
+      const auto &ranges = index->at("shared");
+      if ((id >= (Int_t)ranges.size()) || (ranges[id][1].get<Long64_t>() <= 0))
+         return kFALSE;
+      return GetRecordView(ranges[id][0].get<Long64_t>(), ranges[id][1].get<Long64_t>(), view, buf);
+   }
+
+   auto shared = rootNode.find(jsonio::SharedObjects);
+   if ((shared != rootNode.end()) && (id < (Int_t)shared->size())) {
+      buf = shared->at(id).dump();
+      view = buf;
+      return kTRUE;
+   }
+
+   return kFALSE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read all shared objects into shared table, done before file is overwritten
+
+void TJSONFile::LoadSharedObjects()
+{
+   if (!fDoc)
+      return;
+
+   auto &rootNode = *((nlohmann::json *)fDoc);
+
+   Int_t size = 0;
+   if (fIndexed && rootNode[jsonio::KeysIndex].contains("shared"))
+      size = rootNode[jsonio::KeysIndex]["shared"].size();
+   else if (rootNode.contains(jsonio::SharedObjects))
+      size = rootNode[jsonio::SharedObjects].size();
+
+   if (size > (Int_t)fSharedObjects.size())
+      fSharedObjects.resize(size);
+
+   for (Int_t id = 0; id < size; id++) {
+      if (!fSharedObjects[id].empty())
+         continue;
+      std::string_view view;
+      std::string buf;
+      if (GetSharedView(id, view, buf))
+         fSharedObjects[id] = view;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Enable concurrent-read mode, only for files opened in read mode
+/// In this mode several threads can read objects from the same file simultaneously.
+/// Objects are decoded from the file records with const access to shared data,
+/// parsed key nodes are not used. Reading of directories keys, caches of objects
+/// and statistic counters are protected by the file mutex.
+/// Method must be called before threads start reading, while it prepares tables
+/// used during reading. ROOT::EnableThreadSafety() should be called as well.
+/// All subdirectories are read here, later lists of the directories are not modified.
+/// Objects read in this mode are not added to any directory, caller owns them.
+/// Writing, SetMemoryBudget() and other configuration methods are not thread-safe.
+
+void TJSONFile::SetConcurrentRead(Bool_t on)
+{
+   if (on && IsWritable()) {
+      Error("SetConcurrentRead", "Concurrent read mode is not supported for writable file %s", GetName());
+      return;
+   }
+
+   if (on) {
+      // tables, which otherwise read on demand
+      LoadSubtrees();
+      LoadDefaults();
+      LoadStreamerInfos();
+      ApplyStreamerInfos(kFALSE);
+
+      // directories lists are searched by TDirectoryFile::Get without lock
+      std::function<void(TDirectory *)> readSubdirs = [&readSubdirs](TDirectory *dir) {
+         TIter iter(dir->GetListOfKeys());
+         while (auto key = (TKey *)iter()) {
+            TClass *cl = TClass::GetClass(key->GetClassName());
+            if (!cl || !cl->InheritsFrom(TDirectory::Class()))
+               continue;
+            if (auto subdir = dir->GetDirectory(key->GetName()))
+               readSubdirs(subdir);
+         }
+      };
+      readSubdirs(this);
+   }
+
+   fConcurrentRead = on;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Lock file mutex in concurrent-read mode, otherwise returned lock is empty
+
+std::unique_lock<std::recursive_mutex> TJSONFile::LockConcurrent()
+{
+   if (!fConcurrentRead)
+      return std::unique_lock<std::recursive_mutex>();
+
+   return std::unique_lock<std::recursive_mutex>(fMutex);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Increment counter of read bytes
+
+void TJSONFile::CountBytesRead(Long64_t length)
+{
+   auto lock = LockConcurrent();
+   fBytesRead += length;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Set limit for size of keys records, kept in memory in write mode, 0 - no limit (default)
+/// When limit is exceeded, records of oldest keys are written in final form into temporary
+/// spill file, created next to output file. When file is saved, spilled records are copied
+/// into output file without parsing. Size of object JSON is used as measure of record size
+
+void TJSONFile::SetSpillLimit(Long64_t bytes)
+{
+   if (!IsWritable())
+      return;
+
+   fSpillLimit = bytes > 0 ? bytes : 0;
+   if (fSpillLimit > 0)
+      SpillPendingKeys();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Set size of object JSON, above which object is streamed directly into spill file,
+/// 0 - objects are always built in memory. Default is 64 MB.
+/// Only objects, written with TJSONCodec, can be streamed - for instance histograms.
+/// Such object never exists as complete string in memory: JSON is produced in pieces
+/// and written into the spill file, when file is saved record is copied into output
+/// file in pieces as well. Streamed objects are not deduplicated and not stored as delta.
+/// Key records larger than threshold are also read in pieces with TJSONPullParser,
+/// large bins arrays are decoded directly into the object.
+
+void TJSONFile::SetStreamThreshold(Long64_t bytes)
+{
+   fStreamThreshold = bytes > 0 ? bytes : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns kTRUE if record of such length must not be parsed as whole
+/// Such records are copied as is when file is saved
+
+Bool_t TJSONFile::IsHugeRecord(Long64_t length) const
+{
+   return (fStreamThreshold > 0) && (length >= fStreamThreshold);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns size of object JSON, above which object is streamed into spill file, 0 - never
+
+Long64_t TJSONFile::GetStreamLimit() const
+{
+   return IsWritable() && !fAppend ? fStreamThreshold : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Write streamer infos into shared schema catalog instead of the file
+/// Catalog is JSON Lines file, which can be used by many files - each info is stored
+/// there once under its content hash and file keeps only catalog name and list of hashes.
+/// Relative name is resolved relative to directory of the file, both when file is written
+/// and when it is read. Catalog content is cached in the process, therefore opening many
+/// files with same catalog parses schema only once. Empty name - infos are stored in the file.
+
+void TJSONFile::SetSchemaCatalog(const char *fname)
+{
+   fSchemaCatalog = fname ? fname : "";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns location of schema catalog, relative name is resolved relative to the file
+
+TString TJSONFile::GetSchemaCatalogPath(const char *fname) const
+{
+   if (gSystem->IsAbsoluteFileName(fname))
+      return fname;
+
+   TString dir = gSystem->GetDirName(fRealName);
+   return dir.IsNull() ? TString(fname) : dir + "/" + fname;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Register key with just stored object, which can be spilled later
+
+void TJSONFile::AddPendingKey(TKeyJSON *key, Long64_t size)
+{
+   RemovePendingKey(key);
+
+   // in append mode record is written immediately
+   if (fAppend) {
+      AppendRecord(key);
+      return;
+   }
+
+   if ((fSpillLimit <= 0) || key->IsSubdir())
+      return;
+
+   fPendingKeys.push_back(key);
+   fPendingPos[key] = std::make_pair(std::prev(fPendingKeys.end()), size);
+   fPendingSize += size;
+
+   SpillPendingKeys();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Remove key from list of keys, which can be spilled
+
+void TJSONFile::RemovePendingKey(TKeyJSON *key)
+{
+   auto iter = fPendingPos.find(key);
+   if (iter == fPendingPos.end())
+      return;
+
+   fPendingSize -= iter->second.second;
+   fPendingKeys.erase(iter->second.first);
+   fPendingPos.erase(iter);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Write records of oldest keys into spill file, until memory limit is satisfied
+
+void TJSONFile::SpillPendingKeys()
+{
+   while ((fPendingSize > fSpillLimit) && !fPendingKeys.empty()) {
+      TKeyJSON *key = fPendingKeys.front();
+      RemovePendingKey(key);
+
+      // record may contain subdirectory, which is written differently
+      if (key->IsSubdir() || !key->KeyNode() || ((nlohmann::json *)key->KeyNode())->contains("Keys"))
+         continue;
+
+      std::string rec;
+      key->WriteRecord(rec);
+
+      Long64_t offset = 0;
+      if (!WriteSpill(rec, offset))
+         break;
+
+      key->SetSpilled(offset, rec.length(), jsonio::ContentHash(rec.data(), rec.length()));
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Append record to the spill file, spill file is created with first call
+
+Bool_t TJSONFile::WriteSpill(const std::string &rec, Long64_t &offset)
+{
+   if (!OpenSpill())
+      return kFALSE;
+
+   offset = fSpillSize;
+
+   return AppendSpill(rec.data(), rec.length());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Create spill file, if it was not done before
+
+Bool_t TJSONFile::OpenSpill()
+{
+   if (fSpillFd >= 0)
+      return kTRUE;
+
+   TString fname;
+   ProduceFileNames(fRealName, fname);
+   std::string tmpl = std::string(fname.Data()) + ".spill-XXXXXX";
+   fSpillFd = ::mkstemp(&tmpl[0]);
+   if (fSpillFd < 0) {
+      Error("OpenSpill", "Fail to create spill file %s", tmpl.c_str());
+      fSpillLimit = 0;
+      return kFALSE;
+   }
+   // file is removed when closed
+   ::unlink(tmpl.c_str());
+   fSpillSize = 0;
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Append piece of data at the end of spill file
+/// Used to write record in several pieces, see TKeyJSON::StoreStreamed()
+
+Bool_t TJSONFile::AppendSpill(const char *buf, Long64_t len)
+{
+   if (!OpenSpill())
+      return kFALSE;
+
+   Long64_t pos = 0;
+   while (pos < len) {
+      ssize_t n = ::pwrite(fSpillFd, buf + pos, len - pos, fSpillSize + pos);
+      if (n <= 0) {
+         Error("AppendSpill", "Fail to write %lld bytes into spill file", len);
+         return kFALSE;
+      }
+      pos += n;
+   }
+
+   fSpillSize += len;
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Discard end of spill file, used when record cannot be completed
+
+void TJSONFile::TruncateSpill(Long64_t size)
+{
+   if ((fSpillFd < 0) || (size < 0) || (size >= fSpillSize))
+      return;
+
+   if (::ftruncate(fSpillFd, size) != 0)
+      Warning("TruncateSpill", "Fail to truncate spill file to %lld bytes", size);
+   fSpillSize = size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Calculate content hash of spilled record, record is read in pieces
+
+Bool_t TJSONFile::HashSpill(Long64_t offset, Long64_t length, ULong64_t &hash)
+{
+   jsonio::ContentHasher hasher(length);
+   std::string buf;
+
+   for (Long64_t pos = 0; pos < length; pos += kSpillChunkSize) {
+      Long64_t len = std::min(kSpillChunkSize, length - pos);
+      if (!ReadSpill(offset + pos, len, buf))
+         return kFALSE;
+      hasher.Update(buf.data(), len);
+   }
+
+   hash = hasher.Final();
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read spilled record
+
+Bool_t TJSONFile::ReadSpill(Long64_t offset, Long64_t length, std::string &buf)
+{
+   if ((fSpillFd < 0) || (offset < 0) || (length <= 0) || (offset + length > fSpillSize))
+      return kFALSE;
+
+   buf.resize(length);
+
+   Long64_t pos = 0;
+   while (pos < length) {
+      ssize_t n = ::pread(fSpillFd, &buf[pos], length - pos, offset + pos);
+      if (n <= 0) {
+         Error("ReadSpill", "Fail to read %lld bytes at offset %lld", length, offset);
+         return kFALSE;
+      }
+      pos += n;
+   }
+
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Parse spilled record of the key without loading it into the key
+
+Bool_t TJSONFile::ReadSpilledNode(TKeyJSON *key, void *node)
+{
+   std::string_view view;
+   std::string buf;
+   if (!key->GetRecordView(view, buf))
+      return kFALSE;
+
+   try {
+      *((nlohmann::json *)node) = nlohmann::json::parse(view);
+   } catch (nlohmann::json::exception const &e) {
+      Error("ReadSpilledNode", "Fail to parse spilled record of key %s;%d: %s", key->GetName(), key->GetCycle(), e.what());
+      return kFALSE;
+   }
+
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Copy spilled record into output stream
+/// Data is copied inside kernel with copy_file_range, if not possible - via buffer
+
+Bool_t TJSONFile::CopySpilledRecord(std::ostream &os, Long64_t offset, Long64_t length)
+{
+   if (fSpliceFd >= 0) {
+      os.flush();
+      loff_t outpos = os.tellp();
+      loff_t inpos = offset;
+      Long64_t done = 0;
+      while (done < length) {
+         ssize_t n = ::copy_file_range(fSpillFd, &inpos, fSpliceFd, &outpos, length - done, 0);
+         if (n <= 0)
+            break;
+         done += n;
+      }
+      if (done == length) {
+         os.seekp(outpos);
+         return kTRUE;
+      }
+      // partial copy is overwritten by normal write
+      os.seekp(outpos - done);
+   }
+
+   // large records are copied in pieces
+   std::string buf;
+   for (Long64_t pos = 0; pos < length; pos += kSpillChunkSize) {
+      Long64_t len = std::min(kSpillChunkSize, length - pos);
+      if (!ReadSpill(offset + pos, len, buf))
+         return kFALSE;
+      os.write(buf.data(), len);
+   }
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Set memory budget for parsed keys records in read mode, 0 - no limit (default)
+/// When size of records, read from the file, exceeds budget, least recently used
+/// records are released and read again from the file on next access.
+/// Size of record in the file is used as measure of memory usage
+
+void TJSONFile::SetMemoryBudget(Long64_t bytes)
+{
+   fMemoryBudget = bytes > 0 ? bytes : 0;
+
+   if (fMemoryBudget == 0) {
+      fNodesLRU.clear();
+      fNodesPos.clear();
+      fMemoryUsed = 0;
+   } else {
+      EvictKeysNodes(nullptr);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Mark parsed record of the key as recently used, called when key node is accessed
+/// Only records of read-only files, which can be read again, are accounted
+
+void TJSONFile::TouchKeyNode(TKeyJSON *key)
+{
+   if ((fMemoryBudget <= 0) || IsWritable() || !key->KeyNode() || (key->GetRecordLength() <= 0) || key->IsSubdir())
+      return;
+
+   auto iter = fNodesPos.find(key);
+   if (iter != fNodesPos.end()) {
+      fNodesLRU.splice(fNodesLRU.begin(), fNodesLRU, iter->second);
+      return;
+   }
+
+   fNodesLRU.push_front(key);
+   fNodesPos[key] = fNodesLRU.begin();
+   fMemoryUsed += key->GetRecordLength();
+
+   EvictKeysNodes(key);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Remove key from list of parsed records, called when key node is deleted
+
+void TJSONFile::ForgetKeyNode(TKeyJSON *key)
+{
+   auto iter = fNodesPos.find(key);
+   if (iter == fNodesPos.end())
+      return;
+
+   fMemoryUsed -= key->GetRecordLength();
+   fNodesLRU.erase(iter->second);
+   fNodesPos.erase(iter);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Release least recently used records until memory budget is satisfied
+/// Record of specified key is kept
+
+void TJSONFile::EvictKeysNodes(TKeyJSON *keep)
+{
+   while ((fMemoryUsed > fMemoryBudget) && !fNodesLRU.empty() && (fNodesLRU.back() != keep))
+      fNodesLRU.back()->UnloadKeyNode();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Enable cache of decoded objects with maximal size maxbytes, 0 disables cache (default)
+/// Repeated reading of same key returns copy of cached object instead of decoding JSON.
+/// Size of object is estimated by length of its JSON, least recently used objects
+/// are removed when cache exceeds configured size
+
+void TJSONFile::SetObjectCache(Long64_t maxbytes)
+{
+   fCacheBudget = maxbytes > 0 ? maxbytes : 0;
+   EvictCachedObjects(fCacheBudget);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns copy of cached object for the key, caller owns it
+/// Returns nullptr if object is not in the cache
+
+void *TJSONFile::GetCachedObject(Long64_t keyid, TClass *&cl)
+{
+   auto lock = LockConcurrent();
+
+   auto iter = fCacheObjects.find(keyid);
+   if (iter == fCacheObjects.end())
+      return nullptr;
+
+   auto &entry = iter->second;
+   fCacheLRU.splice(fCacheLRU.begin(), fCacheLRU, entry.fIter);
+
+   cl = entry.fClass;
+   return CloneObject(entry.fObj, entry.fClass);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// Read streamerinfo structures from json format and provide them in the list
-/// It is user responsibility to destroy this list
+/// Keep copy of decoded object in the cache
 
-TFile::InfoListRet TJSONFile::GetStreamerInfoListImpl(bool /* lookupSICache */)
+void TJSONFile::CacheObject(Long64_t keyid, const void *obj, TClass *cl, Long64_t size)
 {
-   ROOT::Internal::RConcurrentHashColl::HashValue hash;
+   auto lock = LockConcurrent();
 
-   auto &rootNode = *((nlohmann::json *)fDoc);
-   auto &sinfonode= rootNode["StreamerInfos"];
+   if ((fCacheBudget <= 0) || (size > fCacheBudget) || !obj || !cl || cl->InheritsFrom(TDirectory::Class()))
+      return;
 
+   ReleaseCachedObject(keyid);
 
-   TList *list = new TList();
-int i=0;
-      while (sinfonode[i].contains("name")) {
+   void *copy = CloneObject(obj, cl);
+   if (!copy)
+      return;
 
-            TString fname = sinfonode[i]["name"].get<std::string>();
-            TString ftitle = sinfonode[i]["title"].get<std::string>();
+   EvictCachedObjects(fCacheBudget - size);
 
-            TStreamerInfo *info = new TStreamerInfo(TClass::GetClass(fname));
-            info->SetTitle(ftitle);
+   fCacheLRU.push_front(keyid);
+   auto &entry = fCacheObjects[keyid];
+   entry.fObj = copy;
+   entry.fClass = cl;
+   entry.fSize = size;
+   entry.fIter = fCacheLRU.begin();
+   fCacheSize += size;
+}
 
-            list->Add(info);
+////////////////////////////////////////////////////////////////////////////////
+/// Remove object of the key from the cache, called when key object is changed or deleted
 
-            Int_t clversion = sinfonode[i]["classversion"].get<int>();
-            info->SetClassVersion(clversion);
-            info->SetOnFileClassVersion(clversion);
-            Int_t checksum = sinfonode[i]["checksum"].get<int>();
-            info->SetCheckSum(checksum);
+void TJSONFile::ReleaseCachedObject(Long64_t keyid)
+{
+   auto lock = LockConcurrent();
 
-            const char *canoptimize = sinfonode[i]["canoptimize"].get<std::string>().c_str();
+   auto iter = fCacheObjects.find(keyid);
+   if (iter == fCacheObjects.end())
+      return;
 
-            if (!canoptimize || (strcmp(canoptimize, jsonio::False) == 0))
-               info->SetBit(TStreamerInfo::kCannotOptimize);
-            else
-               info->ResetBit(TStreamerInfo::kCannotOptimize);
+   auto &entry = iter->second;
+   entry.fClass->Destructor(entry.fObj);
+   fCacheSize -= entry.fSize;
+   fCacheLRU.erase(entry.fIter);
+   fCacheObjects.erase(iter);
+}
 
-            //auto &node=sinfonode[i]["elements"];
+////////////////////////////////////////////////////////////////////////////////
+/// Remove least recently used objects until size of cache does not exceed maxbytes
 
-            int j=0;
-            while (sinfonode[i]["elements"][j].contains("name")) {
-               ReadStreamerElement(&sinfonode[i]["elements"][j], info);
-               j++;
-            }
-         
-         i++;
+void TJSONFile::EvictCachedObjects(Long64_t maxbytes)
+{
+   auto lock = LockConcurrent();
 
-      }
+   while ((fCacheSize > maxbytes) && !fCacheLRU.empty())
+      ReleaseCachedObject(fCacheLRU.back());
+}
 
-   list->SetOwner();
+////////////////////////////////////////////////////////////////////////////////
+/// Enable sharing of repeated JSON subtrees between stored objects
+/// Subtrees like axes, attributes or lists of functions, which JSON is longer than minsize
+/// and which appear several times in the file, are written once in "SharedSubtrees" table
+/// and replaced by {"$shared":id} markers in the objects. 0 disables sharing (default).
+/// File with shared subtrees is written with current format version
 
-   return {list, 0, hash};
+void TJSONFile::SetSubtreeSharing(Int_t minsize)
+{
+   if (IsWritable())
+      fSubtreeSharing = minsize > 0 ? minsize : 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// store data of single TStreamerElement in streamer node
+/// Count subtrees of objects in directory and its subdirectories
 
-void TJSONFile::StoreStreamerElement(void *infonode, TStreamerElement *elem)
+void TJSONFile::CountSubtrees(TDirectory *dir, void *table)
 {
+   TIter iter(dir->GetListOfKeys());
+   TKeyJSON *key = nullptr;
+
+   while ((key = (TKeyJSON *)iter()) != nullptr) {
+      TDirectory *subdir = key->IsSubdir() ? FindKeyDir(dir, key->GetKeyId()) : nullptr;
+      nlohmann::json obj;
+      if (subdir)
+         CountSubtrees(subdir, table);
+      else if (GetStoredObject(key, &obj))
+         ((TJSONSubtreeTable *)table)->Count(obj);
+   }
+}
 
-   TClass *cl = elem->IsA();
-   nlohmann::json info = nlohmann::json::object();
+////////////////////////////////////////////////////////////////////////////////
+/// Provide JSON of key object in the form, how it is written to the file
+/// Members with default values are removed when class defaults are enabled.
+/// Returns kFALSE if key does not have own object or its spilled record is too large to be parsed
 
-   char sbuf[100], namebuf[100];
+Bool_t TJSONFile::GetStoredObject(TKeyJSON *key, void *objnode)
+{
+   auto &obj = *((nlohmann::json *)objnode);
+
+   nlohmann::json spillnode;
+   if (key->IsSpilled()) {
+      if (IsHugeRecord(key->fSpillLength) || !ReadSpilledNode(key, &spillnode) || !spillnode.contains(jsonio::Object))
+         return kFALSE;
+      obj = std::move(spillnode[jsonio::Object]);
+   } else if (key->GetPayload().length() > 0)
+      obj = nlohmann::json::parse(key->GetPayload());
+   else if (key->KeyNode() && ((nlohmann::json *)key->KeyNode())->contains(jsonio::Object))
+      obj = (*((nlohmann::json *)key->KeyNode()))[jsonio::Object];
+   else
+      return kFALSE;
 
-   info["streamerelement"] = cl->GetName(); 
+   if (fDefaultsTable)
+      ((TJSONClassDefaults *)fDefaultsTable)->Suppress(obj);
 
-   info["name"] = elem->GetName();
+   return kTRUE;
+}
 
-   if (strlen(elem->GetTitle()) > 0)
-      info["title"] = elem->GetTitle();
+////////////////////////////////////////////////////////////////////////////////
+/// Enable suppression of members, which are equal to class defaults
+/// Prototype of every stored class is written once in "ClassDefaults" table and
+/// members with same value are omitted in objects. Such files get format version 2
+/// and cannot be read by older versions
 
-   info["v"] = cl->GetClassVersion();
+void TJSONFile::SetClassDefaults(Bool_t on)
+{
+   if (IsWritable())
+      fClassDefaults = on;
+}
 
-   info["type"] = elem->GetType();
+////////////////////////////////////////////////////////////////////////////////
+/// Set table of class prototypes, previous table is deleted
 
-   if (strlen(elem->GetTypeName()) > 0)
-      info["typename"] = elem->GetTypeName();
+void TJSONFile::SetDefaults(void *table)
+{
+   if (fDefaults)
+      delete (nlohmann::json *)fDefaults;
+   fDefaults = table;
+}
 
-   info["size"] = elem->GetSize();
+////////////////////////////////////////////////////////////////////////////////
+/// Read table of class prototypes, returns kFALSE if file does not have it
 
-   if (elem->GetArrayDim() > 0)
-   {
-      nlohmann::json arraydim = nlohmann::json::array();
+Bool_t TJSONFile::LoadDefaults()
+{
+   if (fDefaults)
+      return !((nlohmann::json *)fDefaults)->empty();
 
-      for (int ndim = 0; ndim < elem->GetArrayDim(); ndim++) {
-         arraydim.push_back(elem->GetMaxIndex(ndim));
+   auto table = std::make_unique<nlohmann::json>(nlohmann::json::object());
+
+   if (fDoc) {
+      auto &rootNode = *((nlohmann::json *)fDoc);
+      try {
+         if (fIndexed && rootNode[jsonio::KeysIndex].contains("defaults")) {
+            const auto &range = rootNode[jsonio::KeysIndex]["defaults"];
+            std::string_view view;
+            std::string buf;
+            if (GetRecordView(range[0].get<Long64_t>(), range[1].get<Long64_t>(), view, buf))
+               *table = nlohmann::json::parse(view);
+         } else if (rootNode.contains(jsonio::ClassDefaults)) {
+            *table = rootNode[jsonio::ClassDefaults];
+         }
+      } catch (nlohmann::json::exception const &e) {
+         Error("LoadDefaults", "Fail to read class defaults: %s", e.what());
+         table->clear();
       }
+   }
 
-      info["arraydim"] = arraydim;
+   fDefaults = table.release();
 
+   return !((nlohmann::json *)fDefaults)->empty();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Restore complete object from the form, how it is stored in the file
+/// Shared subtrees are resolved first, then members with class defaults are added
+
+void TJSONFile::ExpandObject(void *node)
+{
+   ResolveSubtrees(node);
+
+   if (node && LoadDefaults())
+      ApplyClassDefaults(*((nlohmann::json *)node), *((nlohmann::json *)fDefaults));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Restore complete object JSON text, result is produced in buf
+/// Text is parsed only when file uses shared subtrees or class defaults
+
+Bool_t TJSONFile::ExpandObject(std::string_view &view, std::string &buf)
+{
+   std::string mark = std::string("\"") + jsonio::SharedMark + "\"";
+   Bool_t subtrees = (view.find(mark) != std::string_view::npos) && LoadSubtrees();
+   if (!subtrees && !LoadDefaults())
+      return kTRUE;
+
+   try {
+      auto node = nlohmann::json::parse(view);
+      ExpandObject(&node);
+      buf = node.dump();
+      view = buf;
+   } catch (nlohmann::json::exception const &e) {
+      Error("ExpandObject", "Fail to parse object: %s", e.what());
+      return kFALSE;
    }
-   if (cl == TStreamerBase::Class())
-   {
-      TStreamerBase *base = (TStreamerBase *)elem;
-      info["baseversion"] = base->GetBaseVersion();
-      info["basechecksum"] = base->GetBaseCheckSum();
-   }
-   else if (cl == TStreamerBasicPointer::Class())
-   {
-      TStreamerBasicPointer *bptr = (TStreamerBasicPointer *)elem;
-      info["countversion"] = bptr->GetCountVersion();
-      info["countname"] = bptr->GetCountName();
-      info["countclass"] = bptr->GetCountClass();
-   }
-   else if (cl == TStreamerLoop::Class())
-   {
-      TStreamerLoop *loop = (TStreamerLoop *)elem;
-      info["countversion"] = loop->GetCountVersion();
-      info["countname"] = loop->GetCountName();
-      info["countclass"] = loop->GetCountClass();
-   }
-   else if ((cl == TStreamerSTL::Class()) || (cl == TStreamerSTLstring::Class()))
-   {
-      TStreamerSTL *stl = (TStreamerSTL *)elem;
-      info["STLtype"] = stl->GetSTLtype();
-      info["Ctype"] = stl->GetCtype();
+
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Set table of decoded shared subtrees, previous table is deleted
+
+void TJSONFile::SetSubtrees(void *table)
+{
+   if (fSubtrees)
+      delete (nlohmann::json *)fSubtrees;
+   fSubtrees = table;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read and decode table of shared subtrees
+/// Each subtree is decoded only once, markers inside table entries are resolved
+/// immediately. Returns kFALSE if file does not have shared subtrees
+
+Bool_t TJSONFile::LoadSubtrees()
+{
+   if (fSubtrees)
+      return !((nlohmann::json *)fSubtrees)->empty();
+
+   auto table = std::make_unique<nlohmann::json>(nlohmann::json::array());
+
+   if (fDoc) {
+      auto &rootNode = *((nlohmann::json *)fDoc);
+      try {
+         if (fIndexed && rootNode[jsonio::KeysIndex].contains("subtrees")) {
+            const auto &range = rootNode[jsonio::KeysIndex]["subtrees"];
+            std::string_view view;
+            std::string buf;
+            if (GetRecordView(range[0].get<Long64_t>(), range[1].get<Long64_t>(), view, buf))
+               *table = nlohmann::json::parse(view);
+         } else if (rootNode.contains(jsonio::SharedSubtrees)) {
+            *table = rootNode[jsonio::SharedSubtrees];
+         }
+      } catch (nlohmann::json::exception const &e) {
+         Error("LoadSubtrees", "Fail to read shared subtrees: %s", e.what());
+         table->clear();
+      }
    }
 
-   (*((nlohmann::json *)infonode))["elements"].push_back(info);
+   // entries reference only subtrees with lower ids
+   fSubtrees = table.release();
+   auto &entries = *((nlohmann::json *)fSubtrees);
+   for (auto &entry : entries)
+      ResolveSubtrees(&entry);
 
+   return !entries.empty();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// read and reconstruct single TStreamerElement from json node
+/// Replace all {"$shared":id} markers in the node by copies of shared subtrees
 
-void TJSONFile::ReadStreamerElement(void *node, TStreamerInfo *info)
+void TJSONFile::ResolveSubtrees(void *node)
 {
-   auto &streamernode = *((nlohmann::json *)node);
+   if (!node || !LoadSubtrees())
+      return;
 
-      TClass *cl = TClass::GetClass(streamernode["streamerelement"].get<std::string>().c_str()); 
-      if (!cl || !cl->InheritsFrom(TStreamerElement::Class()))
-         return;
-      TStreamerElement *elem = (TStreamerElement *)cl->New();
-
-      int elem_type = streamernode["type"].get<int>();
-
-      elem->SetName(streamernode["name"].get<std::string>().c_str());
-      elem->SetTitle(streamernode["title"].get<std::string>().c_str());
-      elem->SetType(elem_type);
-      elem->SetTypeName(streamernode["typename"].get<std::string>().c_str());
-      elem->SetSize(streamernode["size"].get<int>());
-
-      if (cl == TStreamerBase::Class()) {
-         int basever = streamernode["baseversion"].get<int>();
-         ((TStreamerBase *)elem)->SetBaseVersion(basever);
-         Int_t baseCheckSum = streamernode["basechecksum"].get<int>();
-         ((TStreamerBase *)elem)->SetBaseCheckSum(baseCheckSum);
-      } else if (cl == TStreamerBasicPointer::Class()) {
-         TString countname = streamernode["countname"].get<std::string>();
-         TString countclass = streamernode["countclass"].get<std::string>();
-         Int_t countversion = streamernode["countversion"].get<int>();
-
-         ((TStreamerBasicPointer *)elem)->SetCountVersion(countversion);
-         ((TStreamerBasicPointer *)elem)->SetCountName(countname);
-         ((TStreamerBasicPointer *)elem)->SetCountClass(countclass);
-      } else if (cl == TStreamerLoop::Class()) {
-         TString countname = streamernode["countname"].get<std::string>();
-         TString countclass = streamernode["countclass"].get<std::string>();
-         Int_t countversion = streamernode["countversion"].get<int>();
-
-         ((TStreamerLoop *)elem)->SetCountVersion(countversion);
-         ((TStreamerLoop *)elem)->SetCountName(countname);
-         ((TStreamerLoop *)elem)->SetCountClass(countclass);
-      } else if ((cl == TStreamerSTL::Class()) || (cl == TStreamerSTLstring::Class())) {
-         int fSTLtype = streamernode["STLtype"].get<int>();
-         int fCtype = streamernode["Ctype"].get<int>();
-         ((TStreamerSTL *)elem)->SetSTLtype(fSTLtype);
-         ((TStreamerSTL *)elem)->SetCtype(fCtype);
+   auto &table = *((nlohmann::json *)fSubtrees);
+
+   std::vector<nlohmann::json *> stack{(nlohmann::json *)node};
+   while (!stack.empty()) {
+      auto elem = stack.back();
+      stack.pop_back();
+      if (elem->is_object() && (elem->size() == 1) && elem->contains(jsonio::SharedMark)) {
+         std::size_t id = (*elem)[jsonio::SharedMark].get<std::size_t>();
+         if (id < table.size())
+            *elem = table[id];
+         else
+            Error("ResolveSubtrees", "Shared subtree %zu not found", id);
+      } else if (elem->is_structured()) {
+         for (auto &el : *elem)
+            stack.push_back(&el);
       }
+   }
+}
 
-      char namebuf[100];
+////////////////////////////////////////////////////////////////////////////////
+/// Mark shared objects, referenced by keys of directory and its subdirectories
 
-      if (streamernode.contains("numdim")) {
-         int numdim = streamernode["numdim"].get<int>();
-         elem->SetArrayDim(numdim);
-         for (int ndim = 0; ndim < numdim; ndim++) {
-            sprintf(namebuf, "dim%d", ndim);
-            int maxi = streamernode[namebuf].get<int>();
-            elem->SetMaxIndex(ndim, maxi);
+void TJSONFile::MarkSharedObjects(TDirectory *dir, std::vector<Bool_t> &used)
+{
+   TIter iter(dir->GetListOfKeys());
+   TKeyJSON *key = nullptr;
+
+   while ((key = (TKeyJSON *)iter()) != nullptr) {
+      Int_t id = key->GetSharedId();
+      if (key->IsSpilled()) {
+         std::string_view view;
+         std::string buf;
+         if (key->GetRecordView(view, buf)) {
+            TJSONTape tape(view);
+            auto idnode = tape.Root()[jsonio::Shared]["id"];
+            if (idnode.GetType() == TJSONTape::kNumber)
+               id = (Int_t)idnode.GetDouble();
          }
       }
+      if ((id >= 0) && (id < (Int_t)used.size()))
+         used[id] = kTRUE;
+      TDirectory *subdir = key->IsSubdir() ? FindKeyDir(dir, key->GetKeyId()) : nullptr;
+      if (subdir)
+         MarkSharedObjects(subdir, used);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns cached complete object of the key, ownership is passed to the caller
+/// Only single object is cached - normally last read or written cycle
 
-      elem->SetType(elem_type);
-      elem->SetNewType(elem_type);
+void *TJSONFile::TakeDeltaCache(Long64_t keyid)
+{
+   auto lock = LockConcurrent();
+
+   if (!fDeltaCacheNode || (fDeltaCacheId != keyid))
+      return nullptr;
 
-      info->GetElements()->Add(elem);
-   
+   void *res = fDeltaCacheNode;
+   fDeltaCacheNode = nullptr;
+   fDeltaCacheId = 0;
+   return res;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// If true, all correspondent to file TStreamerInfo objects will be stored in file
-/// this allows to apply schema evolution later for this file
-/// may be useful, when file used outside ROOT and TStreamerInfo objects does not required
-/// Can be changed only for newly created file.
+/// Cache complete object of the key, file takes ownership over the node
+/// nullptr just clears the cache
 
-void TJSONFile::SetStoreStreamerInfos(Bool_t store)
+void TJSONFile::SetDeltaCache(Long64_t keyid, void *objnode)
 {
-   if (IsWritable() && (GetListOfKeys()->GetSize() == 0))
-      fStoreStreamerInfos = store;
+   auto lock = LockConcurrent();
+
+   if (fDeltaCacheNode)
+      delete (nlohmann::json *)fDeltaCacheNode;
+
+   fDeltaCacheNode = objnode;
+   fDeltaCacheId = objnode ? keyid : 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -897,6 +3006,11 @@ void TJSONFile::SetStoreStreamerInfos(Bool_t store)
 
 Long64_t TJSONFile::DirCreateEntry(TDirectory *dir)
 {
+   if (fAppend) {
+      Error("DirCreateEntry", "Subdirectory %s cannot be created in append mode", dir->GetName());
+      return 0;
+   }
+
    TDirectory *mother = dir->GetMotherDir();
    if (!mother)
       mother = this;
@@ -960,10 +3074,18 @@ TDirectory *TJSONFile::FindKeyDir(TDirectory *motherdir, Long64_t keyid)
 
 Int_t TJSONFile::DirReadKeys(TDirectory *dir)
 {
+   auto lock = LockConcurrent();
+
    TKeyJSON *key = FindDirKey(dir);
    if (!key)
       return 0;
 
+   if (key->GetSubIndex())
+      return ReadKeysIndex(dir, key->GetSubIndex());
+
+   if (!key->LoadKeyNode())
+      return 0;
+
    return ReadKeysList(dir, key->KeyNode());
 }
 
@@ -992,3 +3114,376 @@ void TJSONFile::DirWriteHeader(TDirectory *dir)
    if (key)
       key->UpdateObject(dir);
 }
+
+////////////////////////////////////////////////////////////////////////////////
+/// Open JSON Lines file in append mode
+/// Every process writing into the same file gets own writer id (file UUID) and
+/// own range of keys ids, therefore writers do not need any coordination
+
+Bool_t TJSONFile::OpenAppendLog()
+{
+   fD = ::open(fRealName.Data(), O_RDWR | O_APPEND | O_CREAT, 0644);
+   if (fD < 0) {
+      Error("OpenAppendLog", "Fail to open file %s for appending", fRealName.Data());
+      return kFALSE;
+   }
+
+   // appended lines would make normal JSON document unreadable
+   if (!IsAppendLog()) {
+      Error("OpenAppendLog", "File %s is not JSON Lines file, cannot append to it", fRealName.Data());
+      ::close(fD);
+      fD = -1;
+      return kFALSE;
+   }
+
+   // records must be self-contained, no references between them
+   fDeduplicate = kFALSE;
+   fDeltaCycles = 0;
+
+   fKeyCounter = ((Long64_t)::getpid()) << 32;
+
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Check if file content is JSON Lines, produced in append mode
+/// Such file is empty or starts with framed record header or with writer id of the record
+
+Bool_t TJSONFile::IsAppendLog() const
+{
+   char buf[64];
+   ssize_t len = ::pread(fD, buf, sizeof(buf), 0);
+   if (len <= 0)
+      return len == 0;
+
+   std::string start(buf, len);
+   std::string ident = "{" + nlohmann::json(jsonio::Writer).dump() + ":";
+
+   return (start[0] == '#') || (start.compare(0, ident.length(), ident) == 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Write single line into JSON Lines file
+/// Records longer than kPlainRecordSize get header line "#length hash"
+/// Offset of record in the file is -1 when it cannot be determined
+
+Bool_t TJSONFile::AppendLine(const std::string &rec, Long64_t &offset, ULong64_t &hash)
+{
+   hash = jsonio::ContentHash(rec.data(), rec.length());
+
+   std::string out;
+   if (rec.length() + 1 > kPlainRecordSize)
+      out = TString::Format("#%lld %016llx\n", (Long64_t)rec.length(), (unsigned long long)hash).Data();
+   Long64_t prefix = out.length();
+   out.append(rec);
+   out.push_back('\n');
+
+   ssize_t n = ::write(fD, out.data(), out.length());
+   if (n != (ssize_t)out.length())
+      return kFALSE;
+
+   fBytesWrite += n;
+
+   // file offset is end of just written record
+   Long64_t end = ::lseek(fD, 0, SEEK_CUR);
+   offset = end < (Long64_t)out.length() ? -1 : end - out.length() + prefix;
+
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Append record of the key to JSON Lines file
+/// Record is written with single write() call on descriptor opened with O_APPEND,
+/// therefore it is placed at the end of file and does not overwrite records of
+/// other processes. POSIX does not promise that concurrent writes into regular file
+/// are never interleaved or partially written, therefore reader validates every record:
+/// records longer than kPlainRecordSize get header line "#length hash", shorter records
+/// must be complete JSON lines. Broken records are detected and skipped by the reader.
+/// Record contains writer and key id, later record with same ids replaces previous,
+/// deleted key marked by tombstone record.
+/// After writing key node is released, object is read back from the file when required
+
+Bool_t TJSONFile::AppendRecord(TKeyJSON *key, Bool_t deleted)
+{
+   if (!fAppend || (fD < 0) || !key)
+      return kFALSE;
+
+   std::string rec;
+   if (deleted)
+      rec = "{}";
+   else if (key->KeyNode())
+      key->WriteRecord(rec);
+   else
+      return kFALSE;
+
+   // writer and key ids are always first members of the record
+   std::string ident = nlohmann::json(jsonio::Writer).dump() + ":" + nlohmann::json(fUUID.AsString()).dump() + "," +
+                       nlohmann::json(jsonio::KeyId).dump() + ":" + std::to_string(key->GetKeyId());
+   if (deleted)
+      ident += "," + nlohmann::json(jsonio::Deleted).dump() + ":true";
+   if (rec.length() > 2)
+      ident.push_back(',');
+   rec.insert(1, ident);
+
+   Long64_t offset = -1;
+   ULong64_t hash = 0;
+   if (!AppendLine(rec, offset, hash)) {
+      Error("AppendRecord", "Fail to append record of key %s;%d", key->GetName(), key->GetCycle());
+      return kFALSE;
+   }
+
+   if (deleted || (offset < 0))
+      return kTRUE;
+
+   key->fRecordOffset = offset;
+   key->fRecordLength = rec.length();
+   key->fRecordHash = hash;
+   key->UnloadKeyNode();
+   key->fPayload.clear();
+
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Append streamer infos record to JSON Lines file, called when file is closed
+/// Every writer appends own record, reader merges them. When schema catalog is
+/// configured, record contains only hashes of infos
+
+void TJSONFile::AppendStreamerInfos()
+{
+   WriteStreamerInfo();
+
+   auto &rootNode = *((nlohmann::json *)fDoc);
+
+   nlohmann::json rec = nlohmann::json::object();
+   for (auto name : {jsonio::SInfos, jsonio::SchemaCatalog, jsonio::SchemaHashes}) {
+      auto iter = rootNode.find(name);
+      if (iter != rootNode.end())
+         rec[name] = std::move(*iter);
+   }
+
+   if (rec.empty())
+      return;
+
+   // writer id is always first member of the record
+   std::string text = rec.dump();
+   text.insert(1, nlohmann::json(jsonio::Writer).dump() + ":" + nlohmann::json(fUUID.AsString()).dump() + ",");
+
+   Long64_t offset = -1;
+   ULong64_t hash = 0;
+   if (!AppendLine(text, offset, hash))
+      Error("AppendStreamerInfos", "Fail to append streamer infos to %s", GetName());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Merge streamer infos record of one writer into the document
+/// Same info, written by several writers, is kept only once
+
+void TJSONFile::MergeStreamerInfos(void *recnode)
+{
+   auto &rec = *((nlohmann::json *)recnode);
+   auto &rootNode = *((nlohmann::json *)fDoc);
+
+   auto infos = rec.find(jsonio::SInfos);
+   if ((infos != rec.end()) && infos->is_array()) {
+      auto &dest = rootNode[jsonio::SInfos];
+      if (!dest.is_array())
+         dest = nlohmann::json::array();
+      for (auto &info : *infos) {
+         if (!info.is_object() || (std::find(dest.begin(), dest.end(), info) != dest.end()))
+            continue;
+         dest.push_back(std::move(info));
+      }
+   }
+
+   auto hashes = rec.find(jsonio::SchemaHashes);
+   auto catalog = rec.find(jsonio::SchemaCatalog);
+   if ((hashes != rec.end()) && hashes->is_array() && (catalog != rec.end()) && catalog->is_string()) {
+      rootNode[jsonio::SchemaCatalog] = *catalog;
+      auto &dest = rootNode[jsonio::SchemaHashes];
+      if (!dest.is_array())
+         dest = nlohmann::json::array();
+      for (auto &hash : *hashes)
+         if (std::find(dest.begin(), dest.end(), hash) == dest.end())
+            dest.push_back(hash);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read keys from JSON Lines file, produced in append mode
+/// Records of several writers may be interleaved. Cycles are assigned in order of
+/// records in the file, newer record of same writer and key id replaces older one.
+/// Broken records (incomplete line or wrong hash of framed record) are skipped.
+/// Only keys attributes are extracted, records are read on demand
+
+Bool_t TJSONFile::ReadAppendLog()
+{
+   fDoc = new nlohmann::json(nlohmann::json::object());
+   fIndexed = kTRUE;
+
+   // empty file is not mapped
+   if (!fMapBuf)
+      return kTRUE;
+
+   ::madvise((void *)fMapBuf, fMapSize, MADV_SEQUENTIAL);
+
+   std::unordered_map<std::string, TKeyJSON *> keys;
+
+   // only attributes and class name of object are parsed
+   auto filter = [](int depth, nlohmann::json::parse_event_t event, nlohmann::json &parsed) {
+      return (event != nlohmann::json::parse_event_t::key) || (depth < 2) || ((depth == 2) && (parsed == "_typename"));
+   };
+
+   Long64_t pos = 0;
+   while (pos < fMapSize) {
+      const char *line = fMapBuf + pos;
+      const char *eol = (const char *)memchr(line, '\n', fMapSize - pos);
+      Long64_t linelen = eol ? eol - line : fMapSize - pos;
+
+      Long64_t offset = pos, length = linelen;
+      ULong64_t hash = 0;
+      pos += linelen + 1;
+
+      if (*line == '#') {
+         char *end = nullptr;
+         length = std::strtoll(line + 1, &end, 10);
+         hash = std::strtoull(end, nullptr, 16);
+         offset = pos;
+         if ((length <= 0) || (offset + length > fMapSize) ||
+             (jsonio::ContentHash(fMapBuf + offset, length) != hash)) {
+            Warning("ReadAppendLog", "Broken framed record at offset %lld in %s, skip it", offset, GetName());
+            continue;
+         }
+         pos = offset + length + 1;
+      }
+
+      if (length <= 0)
+         continue;
+
+      std::string_view view(fMapBuf + offset, length);
+      std::string ident, name, title, created, clname;
+      Bool_t deleted = kFALSE;
+
+      // members of wrong type are handled same as broken record
+      try {
+         auto node = nlohmann::json::parse(view, filter);
+
+         if (!node.is_object())
+            continue;
+
+         if (!node.contains(jsonio::KeyId)) {
+            // streamer infos record, which is parsed completely
+            if (node.contains(jsonio::SInfos) || node.contains(jsonio::SchemaHashes)) {
+               auto infos = nlohmann::json::parse(view);
+               MergeStreamerInfos(&infos);
+            }
+            continue;
+         }
+
+         ident = node.value(jsonio::Writer, "") + ":" + std::to_string(node[jsonio::KeyId].get<Long64_t>());
+         deleted = node.value(jsonio::Deleted, false);
+         name = node.value(jsonio::Name, "");
+         title = node.value(jsonio::Title, "");
+         created = node.value(jsonio::CreateTm, "");
+         if (node.contains(jsonio::Object) && node[jsonio::Object].is_object())
+            clname = node[jsonio::Object].value("_typename", "");
+      } catch (nlohmann::json::exception const &) {
+         Warning("ReadAppendLog", "Broken record at offset %lld in %s, skip it", offset, GetName());
+         continue;
+      }
+
+      auto iter = keys.find(ident);
+
+      if (deleted) {
+         if (iter != keys.end()) {
+            GetListOfKeys()->Remove(iter->second);
+            delete iter->second;
+            keys.erase(iter);
+         }
+         continue;
+      }
+
+      if (iter != keys.end()) {
+         // newer version of same key, it may be renamed
+         auto key = iter->second;
+         key->fRecordOffset = offset;
+         key->fRecordLength = length;
+         key->fRecordHash = hash;
+         key->fClassName = clname.c_str();
+         key->fNbytes = key->fObjlen = length < kMaxInt ? (Int_t)length : kMaxInt;
+         key->SetTitle(title.c_str());
+         if (!created.empty())
+            key->fDatime = TDatime(created.c_str());
+         if (name != key->GetName()) {
+            // keys list is searched by name, cycle is assigned for new name
+            GetListOfKeys()->Remove(key);
+            key->SetName(name.c_str());
+            key->fCycle = AppendKey(key);
+         }
+         continue;
+      }
+
+      TKeyJSON *key = new TKeyJSON(this, ++fKeyCounter, name.c_str(), title.c_str(), clname.c_str(), created.c_str(), 0,
+                                   offset, length);
+      if (hash)
+         key->SetRecordHash(hash);
+      key->fCycle = AppendKey(key);
+
+      keys[ident] = key;
+   }
+
+   ::madvise((void *)fMapBuf, fMapSize, MADV_RANDOM);
+
+   fBytesRead += fMapSize;
+
+   auto &rootNode = *((nlohmann::json *)fDoc);
+   fSInfosPending = rootNode.contains(jsonio::SInfos) || rootNode.contains(jsonio::SchemaHashes);
+
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Convert JSON Lines file, produced in append mode, into normal JSON file
+/// Records are copied without decoding of objects. Writer and key ids are removed,
+/// keys get cycles assigned by the reader. Returns number of copied keys or -1 on error
+
+Int_t TJSONFile::CompactAppendLog(const char *logname, const char *outname)
+{
+   TJSONFile in(logname, "read");
+   if (in.IsZombie())
+      return -1;
+
+   TJSONFile out(outname, "recreate");
+   if (out.IsZombie())
+      return -1;
+
+   Int_t nkeys = 0;
+
+   // AppendKey places new cycle ahead of previous, therefore keys are copied starting from lowest cycles
+   TIter iter(in.GetListOfKeys(), kIterBackward);
+   TKeyJSON *key = nullptr;
+
+   while ((key = (TKeyJSON *)iter()) != nullptr) {
+      if (!key->LoadKeyNode()) {
+         ::Warning("TJSONFile::CompactAppendLog", "Fail to read record of key %s;%d", key->GetName(), key->GetCycle());
+         continue;
+      }
+
+      auto node = new nlohmann::json(*((nlohmann::json *)key->KeyNode()));
+      node->erase(jsonio::Writer);
+      node->erase(jsonio::KeyId);
+      (*node)[jsonio::Cycle] = key->GetCycle();
+
+      key->UnloadKeyNode();
+
+      out.AppendKey(new TKeyJSON(&out, ++out.fKeyCounter, node));
+      nkeys++;
+   }
+
+   // streamer infos of the log are written into output file
+   in.ApplyStreamerInfos(kTRUE);
+
+   out.Close();
+
+   return nkeys;
+}
@@ -14,6 +14,14 @@
 #include "TFile.h"
 #include "Compression.h"
 #include <memory>
+#include <string>
+#include <string_view>
+#include <iosfwd>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 class TKeyJSON;
 class TStreamerElement;
@@ -21,6 +29,8 @@ class TStreamerInfo;
 
 class TJSONFile final : public TFile {
 
+   friend class TKeyJSON;
+
 protected:
    void InitJsonFile(Bool_t create);
    // Interface to basic system I/O routines
@@ -52,6 +62,8 @@ public:
    void Close(Option_t *option = "") final; // *MENU*
    TKey *CreateKey(TDirectory *mother, const TObject *obj, const char *name, Int_t bufsize) final;
    TKey *CreateKey(TDirectory *mother, const void *obj, const TClass *cl, const char *name, Int_t bufsize) final;
+   TKey *CreateKey(TDirectory *mother, const char *name, const char *title, const char *classname,
+                   std::string &payload, void *objnode, Long64_t objsize);
    void DrawMap(const char * = "*", Option_t * = "") final {}
    void FillBuffer(char *&) final {}
    void Flush() final {}
@@ -97,20 +109,122 @@ public:
    void SetStoreStreamerInfos(Bool_t iConvert = kTRUE);
    Bool_t IsStoreStreamerInfos() const { return fStoreStreamerInfos; }
 
+   void SetColumnEncoding(Int_t encoding);
+   Int_t GetColumnEncoding() const { return fColumnEncoding; }
+
+   void SetDeltaCycles(Int_t keyframe);
+   Int_t GetDeltaCycles() const { return fDeltaCycles; }
+
+   void SetDeduplicate(Bool_t on = kTRUE);
+   Bool_t IsDeduplicate() const { return fDeduplicate; }
+
+   void SetSubtreeSharing(Int_t minsize = 256);
+   Int_t GetSubtreeSharing() const { return fSubtreeSharing; }
+
+   void SetClassDefaults(Bool_t on = kTRUE);
+   Bool_t IsClassDefaults() const { return fClassDefaults; }
+
+   void SetObjectCache(Long64_t maxbytes);
+   Long64_t GetObjectCache() const { return fCacheBudget; }
+
+   void SetMemoryBudget(Long64_t bytes);
+   Long64_t GetMemoryBudget() const { return fMemoryBudget; }
+
+   void SetSpillLimit(Long64_t bytes);
+   Long64_t GetSpillLimit() const { return fSpillLimit; }
+
+   void SetStreamThreshold(Long64_t bytes);
+   Long64_t GetStreamThreshold() const { return fStreamThreshold; }
+
+   void SetSchemaCatalog(const char *fname);
+   const char *GetSchemaCatalog() const { return fSchemaCatalog.c_str(); }
+
+   void SetConcurrentRead(Bool_t on = kTRUE);
+   Bool_t IsConcurrentRead() const { return fConcurrentRead; }
+
+   Bool_t IsAppendMode() const { return fAppend; }
+   static Int_t CompactAppendLog(const char *logname, const char *outname);
+
 protected:
    // functions to store streamer infos
 
    void StoreStreamerElement(void *node, TStreamerElement *elem);
-   void ReadStreamerElement(void *node, TStreamerInfo *info);
+   void ReadStreamerElement(const void *node, TStreamerInfo *info);
    //void ReadStreamerElement(int i, int j, TStreamerInfo *info);
 
    Bool_t ReadFromFile();
+   Bool_t ReadIndexTrailer();
+   Bool_t ScanKeysRecords();
+   void ReadFileHeader(void *rootnode);
    Int_t ReadKeysList(TDirectory *dir, void *topnode);
+   Int_t ReadKeysIndex(TDirectory *dir, void *indexnode);
+   Bool_t MapFile();
+   void UnmapFile();
+   Bool_t ReadRecord(Long64_t offset, Long64_t length, std::string &buf);
+   Bool_t GetRecordView(Long64_t offset, Long64_t length, std::string_view &view, std::string &buf);
+   Bool_t LoadStreamerInfos();
+   void ApplyStreamerInfos(Bool_t all);
+   TString GetSchemaCatalogPath(const char *fname) const;
    TKeyJSON *FindDirKey(TDirectory *dir);
    TDirectory *FindKeyDir(TDirectory *mother, Long64_t keyid);
-   void CombineNodesTree(TDirectory *dir, void *topnode, Bool_t dolink);
+
+   Int_t ShareObject(TKeyJSON *key, ULong64_t hash, const std::string &text);
+   void ReleaseContent(TKeyJSON *key, ULong64_t hash);
+   Bool_t GetSharedView(Int_t id, std::string_view &view, std::string &buf);
+   void LoadSharedObjects();
+   void MarkSharedObjects(TDirectory *dir, std::vector<Bool_t> &used);
+
+   void CountSubtrees(TDirectory *dir, void *table);
+   void SetSubtrees(void *table);
+   Bool_t LoadSubtrees();
+   void ResolveSubtrees(void *node);
+
+   Bool_t GetStoredObject(TKeyJSON *key, void *objnode);
+   void SetDefaults(void *table);
+   Bool_t LoadDefaults();
+   void ExpandObject(void *node);
+   Bool_t ExpandObject(std::string_view &view, std::string &buf);
+
+   std::unique_lock<std::recursive_mutex> LockConcurrent();
+   void CountBytesRead(Long64_t length);
+
+   void AddPendingKey(TKeyJSON *key, Long64_t size);
+   void RemovePendingKey(TKeyJSON *key);
+   void SpillPendingKeys();
+   Long64_t GetStreamLimit() const;
+   Bool_t IsHugeRecord(Long64_t length) const;
+   Bool_t OpenSpill();
+   Bool_t WriteSpill(const std::string &rec, Long64_t &offset);
+   Bool_t AppendSpill(const char *buf, Long64_t len);
+   void TruncateSpill(Long64_t size);
+   Bool_t HashSpill(Long64_t offset, Long64_t length, ULong64_t &hash);
+   Bool_t ReadSpill(Long64_t offset, Long64_t length, std::string &buf);
+   Bool_t ReadSpilledNode(TKeyJSON *key, void *node);
+   Bool_t CopySpilledRecord(std::ostream &os, Long64_t offset, Long64_t length);
+
+   void TouchKeyNode(TKeyJSON *key);
+   void ForgetKeyNode(TKeyJSON *key);
+   void EvictKeysNodes(TKeyJSON *keep);
+
+   void *GetCachedObject(Long64_t keyid, TClass *&cl);
+   void CacheObject(Long64_t keyid, const void *obj, TClass *cl, Long64_t size);
+   void ReleaseCachedObject(Long64_t keyid);
+   void EvictCachedObjects(Long64_t maxbytes);
+
+   void *TakeDeltaCache(Long64_t keyid);
+   void SetDeltaCache(Long64_t keyid, void *objnode);
+
+   Bool_t OpenAppendLog();
+   Bool_t ReadAppendLog();
+   Bool_t IsAppendLog() const;
+   Bool_t AppendLine(const std::string &rec, Long64_t &offset, ULong64_t &hash);
+   Bool_t AppendRecord(TKeyJSON *key, Bool_t deleted = kFALSE);
+   void AppendStreamerInfos();
+   void MergeStreamerInfos(void *recnode);
 
    void SaveToFile();
+   void LoadKeysNodes(TDirectory *dir);
+   void WriteKeysRecords(std::ostream &os, TDirectory *dir, void *indexnode);
 
    static void ProduceFileNames(const char *filename, TString &fname);
 
@@ -118,10 +232,75 @@ protected:
 
    Bool_t fStoreStreamerInfos{kTRUE};  //! should streamer infos stored in JSON file
 
+   enum ESInfosFilter { kSInfosAll, kSInfosDiffer, kSInfosSame };
+
+   Bool_t fSInfosPending{kFALSE};      //! streamer infos of the file not yet applied, done when first object is read
+   Bool_t fSInfosPartial{kFALSE};      //! only streamer infos, which differ from loaded dictionaries, were applied
+   Int_t fSInfosFilter{kSInfosAll};    //! which streamer infos provided by GetStreamerInfoListImpl, see ESInfosFilter
+   std::string fSchemaCatalog;         //! catalog file, where streamer infos are written, empty - stored in the file
+
    Int_t fIOVersion{0}; //! indicates format of ROOT json file
 
    Long64_t fKeyCounter{0}; //! counter of created keys, used for keys id
 
+   Bool_t fIndexed{kFALSE}; //! keys records are read on demand, using offsets from keys index
+
+   const char *fMapBuf{nullptr}; //! file content mapped into memory in read mode
+   Long64_t fMapSize{0};         //! size of mapped file content
+
+   Int_t fColumnEncoding{0};       //! encoding of TTree columns, see jsonio::EColumnEncoding
+   Bool_t fColumnarStored{kFALSE}; //! columnar trees were written, file requires current format version
+
+   Int_t fDeltaCycles{0};          //! store new cycles as delta to previous cycle, every N-th cycle stored full
+   Long64_t fDeltaCacheId{0};      //! id of key, which complete object is cached
+   void *fDeltaCacheNode{nullptr}; //! cached complete object, used as base for delta cycles
+   Bool_t fDeltaStored{kFALSE};    //! delta records were produced, file requires current format version
+
+   Bool_t fDeduplicate{kFALSE};                //! store identical objects only once
+   std::vector<std::string> fSharedObjects;    //! JSON of objects, shared by several keys
+   std::unordered_map<ULong64_t, std::pair<TKeyJSON *, Int_t>> fContentKeys; //! content hash -> first key and shared id
+
+   Int_t fSubtreeSharing{0};        //! minimal JSON length of subtree, shared between objects, 0 - no sharing
+   void *fSubtreeTable{nullptr};    //! table of repeated subtrees, used only during SaveToFile
+   void *fSubtrees{nullptr};        //! decoded shared subtrees of the file
+
+   Bool_t fClassDefaults{kFALSE};   //! omit members, which are equal to class defaults
+   void *fDefaultsTable{nullptr};   //! prototypes of classes, collected during SaveToFile
+   void *fDefaults{nullptr};        //! prototypes of classes, read from the file
+
+   struct CachedObject {
+      void *fObj{nullptr};                 // decoded object, owned by cache
+      TClass *fClass{nullptr};             // class of object
+      Long64_t fSize{0};                   // estimated size of object
+      std::list<Long64_t>::iterator fIter; // position in LRU list
+   };
+
+   Long64_t fCacheBudget{0};                                //! maximal size of cached objects, 0 - no cache
+   Long64_t fCacheSize{0};                                  //! current size of cached objects
+   std::list<Long64_t> fCacheLRU;                           //! keys ids, most recently used first
+   std::unordered_map<Long64_t, CachedObject> fCacheObjects; //! decoded objects for keys ids
+
+   Long64_t fMemoryBudget{0};                                           //! maximal size of parsed records, 0 - no limit
+   Long64_t fMemoryUsed{0};                                             //! size of parsed records in memory
+   std::list<TKeyJSON *> fNodesLRU;                                     //! keys with parsed records, most recently used first
+   std::unordered_map<TKeyJSON *, std::list<TKeyJSON *>::iterator> fNodesPos; //! position of key in LRU list
+
+   Long64_t fSpillLimit{0};           //! maximal size of keys records in memory in write mode, 0 - no limit
+   Long64_t fPendingSize{0};          //! size of records, which can be spilled
+   std::list<TKeyJSON *> fPendingKeys; //! keys with stored objects, oldest first
+   std::unordered_map<TKeyJSON *, std::pair<std::list<TKeyJSON *>::iterator, Long64_t>> fPendingPos; //! position and size of pending key
+   Int_t fSpillFd{-1};                //! descriptor of temporary spill file
+   Long64_t fSpillSize{0};            //! size of spill file
+   Int_t fSpliceFd{-1};               //! descriptor of output file, used for copy of spilled records
+   Long64_t fStreamThreshold{64 * 1024 * 1024}; //! size of object JSON, above which object is streamed into spill file
+
+   static constexpr Long64_t kSpillChunkSize = 1024 * 1024; ///< size of pieces, in which large records are streamed and copied
+
+   Bool_t fConcurrentRead{kFALSE};    //! several threads may read objects simultaneously
+   std::recursive_mutex fMutex;       //! protects directories keys and caches in concurrent-read mode
+
+   Bool_t fAppend{kFALSE};            //! JSON Lines file, every key record appended when object is stored
+
    ClassDefOverride(TJSONFile, 0) // ROOT file in JSON format
 };
 
@@ -0,0 +1,440 @@
+// Author: agent  16.10.2026
+
+/*************************************************************************
+ * Copyright (C) 1995-2026, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//________________________________________________________________________
+//
+// TJSONFileMerger merges content of many JSON files into single file,
+// like hadd does for binary ROOT files.
+//
+//   TJSONFileMerger merger;
+//   merger.OutputFile("sum.json");
+//   merger.AddFile("job1.json");
+//   merger.AddFile("job2.json");
+//   merger.Merge();
+//
+// Input files are read by pool of threads, every thread accumulates
+// objects of the files it has read. At the end partial results are merged
+// and written into output. Output is TJSONFile, or binary TFile when name
+// has ".root" suffix.
+//
+// Only highest cycle of every key is merged. Subdirectories are merged
+// recursively. Histograms with identical binning are added directly as
+// bins arrays, other objects are merged with Merge() method of their class.
+// Objects without Merge() method are taken from first file where they appear.
+// StreamerInfos of all input files are written into output.
+//
+// Since partial results are combined in arbitrary order, sums of floating
+// point values may differ in last digits between runs.
+//________________________________________________________________________
+
+#include "TJSONFileMerger.h"
+
+#include "TJSONFile.h"
+#include "TROOT.h"
+#include "TSystem.h"
+#include "TKey.h"
+#include "TClass.h"
+#include "TList.h"
+#include "TH1.h"
+#include "TAxis.h"
+#include "TArrayD.h"
+#include "TArrayF.h"
+#include "TArrayI.h"
+#include "TStreamerInfo.h"
+#include "TFileMergeInfo.h"
+#include "TError.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <set>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+/// Add arrays element by element, plain loop is vectorized by compiler
+template <typename T>
+void AddBins(T *dst, const T *src, Int_t n)
+{
+   for (Int_t i = 0; i < n; i++)
+      dst[i] += src[i];
+}
+
+/// Add bins contents, if both histograms use array of type ARR
+template <typename ARR>
+Bool_t AddBinArrays(TH1 *h1, TH1 *h2)
+{
+   auto a1 = dynamic_cast<ARR *>(h1);
+   auto a2 = dynamic_cast<ARR *>(h2);
+   if (!a1 || !a2 || (a1->fN != a2->fN))
+      return kFALSE;
+
+   AddBins(a1->fArray, a2->fArray, a1->fN);
+   return kTRUE;
+}
+
+/// Check that axes have identical binning and no labels
+Bool_t SameBinning(const TAxis *a1, const TAxis *a2)
+{
+   if ((a1->GetNbins() != a2->GetNbins()) || (a1->GetXmin() != a2->GetXmin()) || (a1->GetXmax() != a2->GetXmax()))
+      return kFALSE;
+
+   if (a1->GetLabels() || a2->GetLabels())
+      return kFALSE;
+
+   const TArrayD *b1 = a1->GetXbins(), *b2 = a2->GetXbins();
+   if (b1->fN != b2->fN)
+      return kFALSE;
+
+   return std::equal(b1->fArray, b1->fArray + b1->fN, b2->fArray);
+}
+
+/// Add histogram src to dst directly via bins arrays
+/// Returns kFALSE if histograms are not compatible, dst is not changed then
+Bool_t AddHistograms(TObject *dst, TObject *src)
+{
+   auto h1 = dynamic_cast<TH1 *>(dst);
+   auto h2 = dynamic_cast<TH1 *>(src);
+
+   if (!h1 || !h2 || (h1->IsA() != h2->IsA()))
+      return kFALSE;
+
+   // profiles have extra arrays, handled by TProfile::Merge()
+   if (h1->InheritsFrom("TProfile") || h1->InheritsFrom("TProfile2D") || h1->InheritsFrom("TProfile3D"))
+      return kFALSE;
+
+   if (h1->GetBuffer() || h2->GetBuffer() || (h1->GetNcells() != h2->GetNcells()) ||
+       (h1->GetSumw2N() != h2->GetSumw2N()))
+      return kFALSE;
+
+   if (!SameBinning(h1->GetXaxis(), h2->GetXaxis()) || !SameBinning(h1->GetYaxis(), h2->GetYaxis()) ||
+       !SameBinning(h1->GetZaxis(), h2->GetZaxis()))
+      return kFALSE;
+
+   // statistics must be taken before bins are changed
+   Double_t s1[TH1::kNstat], s2[TH1::kNstat];
+   std::fill(s1, s1 + TH1::kNstat, 0.);
+   std::fill(s2, s2 + TH1::kNstat, 0.);
+   h1->GetStats(s1);
+   h2->GetStats(s2);
+   Double_t entries = h1->GetEntries() + h2->GetEntries();
+
+   if (!AddBinArrays<TArrayD>(h1, h2) && !AddBinArrays<TArrayF>(h1, h2) && !AddBinArrays<TArrayI>(h1, h2))
+      return kFALSE;
+
+   if (h1->GetSumw2N() > 0)
+      AddBins(h1->GetSumw2()->fArray, h2->GetSumw2()->fArray, h1->GetSumw2N());
+
+   for (Int_t i = 0; i < TH1::kNstat; i++)
+      s1[i] += s2[i];
+
+   h1->PutStats(s1);
+   h1->SetEntries(entries);
+
+   return kTRUE;
+}
+
+struct TJSONMergeEntry {
+   std::string fDir;        ///< path of directory
+   std::string fName;       ///< key name
+   std::string fTitle;      ///< key title
+   TClass *fClass{nullptr}; ///< class of object
+   TObject *fObj{nullptr};  ///< merged object, owned by entry
+   Bool_t fIsDir{kFALSE};   ///< entry is subdirectory
+   Bool_t fWarned{kFALSE};  ///< warning about not mergeable object was printed
+   Int_t fFile{0};          ///< index of input file, where entry appears first
+   Long64_t fOrder{0};      ///< number of entry in that file
+};
+
+class TJSONMergeTable {
+public:
+   std::unordered_map<std::string, TJSONMergeEntry> fEntries;  ///< entries by full name
+   std::set<std::pair<std::string, UInt_t>> fInfos;             ///< class names and checksums of streamer infos
+   Long64_t fOrder{0};                                          ///< counter of entries in current file
+
+   TJSONMergeTable() = default;
+   TJSONMergeTable(const TJSONMergeTable &) = delete;
+   TJSONMergeTable(TJSONMergeTable &&) = default;
+
+   ~TJSONMergeTable()
+   {
+      for (auto &el : fEntries)
+         delete el.second.fObj;
+   }
+
+   /// Accumulate object in the entry, ownership over object is taken
+   void Accumulate(TJSONMergeEntry &entry, TObject *obj)
+   {
+      if (!entry.fObj) {
+         entry.fObj = obj;
+         return;
+      }
+
+      if (obj->IsA() != entry.fObj->IsA()) {
+         ::Warning("TJSONFileMerger::Merge", "Object %s has class %s, but %s is expected, skip it", entry.fName.c_str(),
+                   obj->ClassName(), entry.fObj->ClassName());
+      } else if (!AddHistograms(entry.fObj, obj)) {
+         if (auto func = entry.fObj->IsA()->GetMerge()) {
+            TList list;
+            list.Add(obj);
+            TFileMergeInfo info(nullptr);
+            func(entry.fObj, &list, &info);
+         } else if (!entry.fWarned) {
+            ::Warning("TJSONFileMerger::Merge", "Class %s of object %s does not have Merge() method, first object is kept",
+                      entry.fObj->ClassName(), entry.fName.c_str());
+            entry.fWarned = kTRUE;
+         }
+      }
+
+      delete obj;
+   }
+
+   /// Find or create entry for the key
+   TJSONMergeEntry *GetEntry(const std::string &path, TKey *key, TClass *cl, Int_t nfile)
+   {
+      std::string fullname = path.empty() ? key->GetName() : path + "/" + key->GetName();
+
+      auto res = fEntries.emplace(fullname, TJSONMergeEntry());
+      auto &entry = res.first->second;
+
+      if (res.second) {
+         entry.fDir = path;
+         entry.fName = key->GetName();
+         entry.fTitle = key->GetTitle();
+         entry.fClass = cl;
+         entry.fFile = nfile;
+         entry.fOrder = fOrder++;
+      } else if (entry.fIsDir != cl->InheritsFrom(TDirectory::Class())) {
+         ::Warning("TJSONFileMerger::Merge", "Key %s has class %s, but %s is expected, skip it", fullname.c_str(),
+                   cl->GetName(), entry.fClass->GetName());
+         return nullptr;
+      }
+
+      return &entry;
+   }
+
+   /// Read highest cycles of all keys in directory and accumulate them
+   void ReadDir(TDirectory *dir, const std::string &path, Int_t nfile)
+   {
+      std::vector<TKey *> keys;
+      std::unordered_map<std::string, std::size_t> pos;
+
+      TIter iter(dir->GetListOfKeys());
+      while (auto key = (TKey *)iter()) {
+         auto res = pos.emplace(key->GetName(), keys.size());
+         if (res.second)
+            keys.emplace_back(key);
+         else if (key->GetCycle() > keys[res.first->second]->GetCycle())
+            keys[res.first->second] = key;
+      }
+
+      for (auto key : keys) {
+         TClass *cl = TClass::GetClass(key->GetClassName());
+         if (!cl || !cl->IsTObject()) {
+            ::Warning("TJSONFileMerger::Merge", "Key %s of class %s cannot be merged, skip it", key->GetName(),
+                      key->GetClassName());
+            continue;
+         }
+
+         if (cl->InheritsFrom(TDirectory::Class())) {
+            auto entry = GetEntry(path, key, cl, nfile);
+            if (!entry)
+               continue;
+            entry->fIsDir = kTRUE;
+            if (auto subdir = dir->GetDirectory(key->GetName()))
+               ReadDir(subdir, path.empty() ? key->GetName() : path + "/" + key->GetName(), nfile);
+            continue;
+         }
+
+         TObject *obj = key->ReadObj();
+         if (!obj) {
+            ::Error("TJSONFileMerger::Merge", "Fail to read object %s from %s", key->GetName(), dir->GetName());
+            continue;
+         }
+
+         // object must survive closing of input file
+         if (auto func = obj->IsA()->GetDirectoryAutoAdd())
+            func(obj, nullptr);
+
+         if (auto entry = GetEntry(path, key, cl, nfile))
+            Accumulate(*entry, obj);
+         else
+            delete obj;
+      }
+   }
+
+   /// Read all objects of input file
+   Bool_t ReadFile(const std::string &fname, Int_t nfile)
+   {
+      std::unique_ptr<TFile> f;
+      if (TString(fname.c_str()).EndsWith(".root"))
+         f.reset(TFile::Open(fname.c_str()));
+      else
+         f.reset(new TJSONFile(fname.c_str(), "read"));
+
+      if (!f || f->IsZombie()) {
+         ::Error("TJSONFileMerger::Merge", "Fail to open input file %s", fname.c_str());
+         return kFALSE;
+      }
+
+      if (auto infos = f->GetStreamerInfoList()) {
+         TIter iter(infos);
+         while (auto info = (TStreamerInfo *)iter())
+            fInfos.emplace(info->GetName(), info->GetCheckSum());
+         delete infos;
+      }
+
+      fOrder = 0;
+      ReadDir(f.get(), "", nfile);
+
+      f->Close();
+
+      return kTRUE;
+   }
+
+   /// Move entries of other table into this table
+   void Merge(TJSONMergeTable &other)
+   {
+      for (auto &el : other.fEntries) {
+         auto &src = el.second;
+         auto iter = fEntries.find(el.first);
+         if (iter == fEntries.end()) {
+            fEntries.emplace(el.first, src);
+         } else {
+            auto &dst = iter->second;
+            if (std::make_pair(src.fFile, src.fOrder) < std::make_pair(dst.fFile, dst.fOrder)) {
+               dst.fFile = src.fFile;
+               dst.fOrder = src.fOrder;
+            }
+            if (src.fObj && (dst.fIsDir == src.fIsDir))
+               Accumulate(dst, src.fObj);
+            else
+               delete src.fObj;
+         }
+         src.fObj = nullptr;
+      }
+
+      fInfos.insert(other.fInfos.begin(), other.fInfos.end());
+   }
+};
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+/// Set name of output file. Existing file is overwritten only when force specified
+
+Bool_t TJSONFileMerger::OutputFile(const char *name, Bool_t force)
+{
+   if (!name || !*name)
+      return kFALSE;
+
+   if (!force && !gSystem->AccessPathName(name, kFileExists)) {
+      ::Error("TJSONFileMerger::OutputFile", "Output file %s already exists", name);
+      return kFALSE;
+   }
+
+   fOutput = name;
+   fForce = force;
+
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Merge all input files into output file
+/// Returns kFALSE if any input file cannot be read or output cannot be written
+
+Bool_t TJSONFileMerger::Merge()
+{
+   if (fOutput.empty() || fInputs.empty()) {
+      ::Error("TJSONFileMerger::Merge", "Output file or input files are not specified");
+      return kFALSE;
+   }
+
+   Int_t nthreads = fNumThreads > 0 ? fNumThreads : (Int_t)std::thread::hardware_concurrency();
+   nthreads = std::max(1, std::min(nthreads, (Int_t)fInputs.size()));
+
+   if (nthreads > 1)
+      ROOT::EnableThreadSafety();
+
+   std::vector<TJSONMergeTable> tables(nthreads);
+   std::atomic<Int_t> next{0};
+   std::atomic<Bool_t> failed{kFALSE};
+
+   auto worker = [&](Int_t n) {
+      Int_t nfile;
+      while (!failed && ((nfile = next++) < (Int_t)fInputs.size()))
+         if (!tables[n].ReadFile(fInputs[nfile], nfile))
+            failed = kTRUE;
+   };
+
+   std::vector<std::thread> threads;
+   for (Int_t n = 1; n < nthreads; n++)
+      threads.emplace_back(worker, n);
+   worker(0);
+   for (auto &thrd : threads)
+      thrd.join();
+
+   if (failed)
+      return kFALSE;
+
+   for (Int_t n = 1; n < nthreads; n++)
+      tables[0].Merge(tables[n]);
+
+   auto &table = tables[0];
+
+   std::unique_ptr<TFile> out;
+   const char *option = fForce ? "recreate" : "create";
+   if (TString(fOutput.c_str()).EndsWith(".root"))
+      out.reset(TFile::Open(fOutput.c_str(), option));
+   else
+      out.reset(new TJSONFile(fOutput.c_str(), option));
+
+   if (!out || out->IsZombie()) {
+      ::Error("TJSONFileMerger::Merge", "Fail to create output file %s", fOutput.c_str());
+      return kFALSE;
+   }
+
+   // union of streamer infos of all input files
+   for (auto &info : table.fInfos) {
+      TClass *cl = TClass::GetClass(info.first.c_str());
+      if (auto si = cl ? cl->FindStreamerInfo(info.second) : nullptr)
+         out->TagStreamerInfo(si);
+   }
+
+   // entries are written in order of first appearance in input files
+   std::vector<TJSONMergeEntry *> entries;
+   for (auto &el : table.fEntries)
+      entries.emplace_back(&el.second);
+   std::sort(entries.begin(), entries.end(), [](const TJSONMergeEntry *e1, const TJSONMergeEntry *e2) {
+      return std::make_pair(e1->fFile, e1->fOrder) < std::make_pair(e2->fFile, e2->fOrder);
+   });
+
+   Bool_t res = kTRUE;
+
+   for (auto entry : entries) {
+      TDirectory *dir = entry->fDir.empty() ? out.get() : out->mkdir(entry->fDir.c_str(), "", kTRUE);
+      if (!dir) {
+         res = kFALSE;
+         continue;
+      }
+      if (entry->fIsDir) {
+         if (!dir->GetDirectory(entry->fName.c_str()))
+            dir->mkdir(entry->fName.c_str(), entry->fTitle.c_str());
+      } else if (entry->fObj && (dir->WriteTObject(entry->fObj, entry->fName.c_str()) <= 0)) {
+         ::Error("TJSONFileMerger::Merge", "Fail to write object %s", entry->fName.c_str());
+         res = kFALSE;
+      }
+   }
+
+   out->Close();
+
+   return res;
+}
@@ -0,0 +1,45 @@
+// Author: agent  16.10.2026
+
+/*************************************************************************
+ * Copyright (C) 1995-2026, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TJSONFileMerger
+#define ROOT_TJSONFileMerger
+
+#include "RtypesCore.h"
+
+#include <string>
+#include <vector>
+
+class TJSONFileMerger {
+
+private:
+   TJSONFileMerger(const TJSONFileMerger &) = delete;            // TJSONFileMerger cannot be copied
+   TJSONFileMerger &operator=(const TJSONFileMerger &) = delete; // TJSONFileMerger cannot be copied
+
+   std::vector<std::string> fInputs; //! names of input files
+   std::string fOutput;              //! name of output file
+   Bool_t fForce{kFALSE};            //! overwrite existing output file
+   Int_t fNumThreads{0};             //! number of reading threads, 0 - number of cores
+
+public:
+   TJSONFileMerger() = default;
+
+   void AddFile(const char *name) { fInputs.emplace_back(name); }
+   Int_t GetNumFiles() const { return (Int_t)fInputs.size(); }
+
+   Bool_t OutputFile(const char *name, Bool_t force = kFALSE);
+   const char *GetOutputFileName() const { return fOutput.c_str(); }
+
+   void SetNumThreads(Int_t n) { fNumThreads = n > 0 ? n : 0; }
+   Int_t GetNumThreads() const { return fNumThreads; }
+
+   Bool_t Merge();
+};
+
+#endif
@@ -0,0 +1,335 @@
+// Author: agent  16.10.2026
+
+/*************************************************************************
+ * Copyright (C) 1995-2026, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//________________________________________________________________________
+//
+// TJSONPullParser reads JSON text from random-access source in chunks of
+// limited size, therefore text of arbitrary size never kept in memory.
+// Values are consumed one after another: member names, numbers, numeric
+// arrays are decoded directly from the chunk buffer, all other values can
+// be skipped.
+//
+// ReadSkeleton() reads JSON object, where all members are copied into
+// small "skeleton" text, except large values, which are replaced by null.
+// Positions of such values are remembered and later arrays can be decoded
+// directly into destination memory with ReadArray(). Skeleton can be
+// navigated with TJSONTape as usual. This is used by TJSONCodec to read
+// histograms with huge bins arrays, see TKeyJSON::ReadStreamed().
+//________________________________________________________________________
+
+#include "TJSONPullParser.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/// Create parser for source with specified length
+/// Source is read in pieces of chunk size
+
+TJSONPullParser::TJSONPullParser(Long64_t length, const Source_t &source, Long64_t chunk)
+   : fLength(length), fSource(source), fChunk(chunk > 64 ? chunk : 64)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Set current position in the source
+/// Data is read again only if position outside current buffer
+
+void TJSONPullParser::Seek(Long64_t pos)
+{
+   if ((pos >= fBufStart) && (pos <= fBufStart + (Long64_t)fBuf.length())) {
+      fCur = pos - fBufStart;
+   } else {
+      fBuf.clear();
+      fBufStart = pos;
+      fCur = 0;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Ensure that n bytes after current position are in the buffer, reading next chunk if necessary
+/// Returns kTRUE if at least one byte is available
+
+Bool_t TJSONPullParser::Ensure(Long64_t n)
+{
+   if (fCur + n <= (Long64_t)fBuf.length())
+      return kTRUE;
+
+   Long64_t pos = Tell();
+   if (!fFailed && (pos + (Long64_t)fBuf.length() - fCur < fLength)) {
+      // data after current position is read again together with next chunk
+      Long64_t len = std::min(std::max(n, fChunk), fLength - pos);
+      if (!fSource(pos, len, fBuf) || ((Long64_t)fBuf.length() != len)) {
+         fFailed = kTRUE;
+         fBuf.clear();
+      }
+      fBufStart = pos;
+      fCur = 0;
+   }
+
+   return fCur < (Long64_t)fBuf.length();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Skip white spaces and return next character, 0 at the end of data
+
+char TJSONPullParser::Peek()
+{
+   while (Ensure(1)) {
+      char c = fBuf[fCur];
+      if ((c != ' ') && (c != '\n') && (c != '\r') && (c != '\t'))
+         return c;
+      fCur++;
+   }
+   return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Consume expected character, white spaces before are skipped
+
+Bool_t TJSONPullParser::Expect(char c)
+{
+   if (Peek() != c)
+      return kFALSE;
+   fCur++;
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Start reading of JSON object
+
+Bool_t TJSONPullParser::BeginObject()
+{
+   return Expect('{');
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read name of next object member, value of member should be consumed afterwards
+/// Escape sequences are kept in the name as is
+/// Returns 1 if name is read, 0 at the end of object and -1 on error
+
+Int_t TJSONPullParser::NextName(std::string &name)
+{
+   char c = Peek();
+   if (c == '}') {
+      fCur++;
+      return 0;
+   }
+   if (c == ',') {
+      fCur++;
+      c = Peek();
+   }
+   if (c != '"')
+      return -1;
+   fCur++;
+
+   name.clear();
+   while (Ensure(1)) {
+      c = fBuf[fCur++];
+      if (c == '"')
+         return Expect(':') ? 1 : -1;
+      if (c == '\\') {
+         name.push_back(c);
+         if (!Ensure(1))
+            return -1;
+         c = fBuf[fCur++];
+      }
+      name.push_back(c);
+   }
+
+   return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Scan value at current position
+/// Text of the value is collected in capture until it exceeds limit, overflow is set then
+/// For arrays number of elements is returned in count
+
+Bool_t TJSONPullParser::Scan(std::string *capture, Long64_t limit, Bool_t &overflow, Long64_t *count)
+{
+   overflow = kFALSE;
+   if (capture)
+      capture->clear();
+
+   if (!Peek())
+      return kFALSE;
+
+   Int_t depth = 0;
+   Bool_t instring = kFALSE, escaped = kFALSE, done = kFALSE, stop = kFALSE, any = kFALSE;
+   Long64_t commas = 0, scanned = 0;
+
+   while (!done && !stop && Ensure(1)) {
+      Long64_t size = fBuf.length(), begin = fCur;
+
+      for (; !done && (fCur < size); fCur++) {
+         char c = fBuf[fCur];
+         if (instring) {
+            if (escaped)
+               escaped = kFALSE;
+            else if (c == '\\')
+               escaped = kTRUE;
+            else if (c == '"')
+               instring = kFALSE;
+            done = !instring && (depth == 0);
+            continue;
+         }
+
+         Bool_t space = (c == ' ') || (c == '\n') || (c == '\r') || (c == '\t');
+         if ((depth == 1) && !space && (c != ']'))
+            any = kTRUE;
+
+         // primitive value ends with delimiter, which is not consumed
+         if ((depth == 0) && (space || (c == ',') || (c == '}') || (c == ']'))) {
+            stop = kTRUE;
+            break;
+         }
+
+         switch (c) {
+         case '"': instring = kTRUE; break;
+         case '{':
+         case '[': depth++; break;
+         case '}':
+         case ']': done = (--depth == 0); break;
+         case ',':
+            if (depth == 1)
+               commas++;
+            break;
+         }
+      }
+
+      scanned += fCur - begin;
+
+      if (capture && !overflow) {
+         capture->append(fBuf, begin, fCur - begin);
+         if ((Long64_t)capture->length() > limit) {
+            overflow = kTRUE;
+            capture->clear();
+         }
+      }
+   }
+
+   if (count)
+      *count = any ? commas + 1 : 0;
+
+   // primitive value may end with delimiter or with end of data
+   return done || ((depth == 0) && !instring && (scanned > 0));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Skip value at current position
+
+Bool_t TJSONPullParser::SkipValue()
+{
+   Bool_t overflow = kFALSE;
+   return Scan(nullptr, 0, overflow, nullptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read number at current position, boolean values are accepted as 0 and 1
+
+Bool_t TJSONPullParser::ReadNumber(Double_t &value)
+{
+   char c = Peek();
+   if ((c == 't') || (c == 'f')) {
+      const char *word = (c == 't') ? "true" : "false";
+      Long64_t len = strlen(word);
+      if (!Ensure(len) || fBuf.compare(fCur, len, word) != 0)
+         return kFALSE;
+      fCur += len;
+      value = (c == 't') ? 1 : 0;
+      return kTRUE;
+   }
+
+   Ensure(64);
+   const char *ptr = fBuf.data() + fCur;
+   char *next = nullptr;
+   value = std::strtod(ptr, &next);
+   if (next == ptr)
+      return kFALSE;
+   fCur += next - ptr;
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns number of elements of array at position pos, counted without decoding of values
+/// Sparse array provides length explicitly. Returns -1 if value is not an array
+
+Long64_t TJSONPullParser::ArrayLength(Long64_t pos)
+{
+   Seek(pos);
+
+   char c = Peek();
+   if (c == '[') {
+      Bool_t overflow = kFALSE;
+      Long64_t count = 0;
+      return Scan(nullptr, 0, overflow, &count) ? count : -1;
+   }
+
+   if ((c != '{') || !BeginObject())
+      return -1;
+
+   std::string name;
+   while (NextName(name) > 0) {
+      Double_t value = 0;
+      if (name == "len")
+         return ReadNumber(value) ? (Long64_t)value : -1;
+      if (!SkipValue())
+         break;
+   }
+
+   return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read object at current position into text, where members with values larger than
+/// limit are replaced by null. Positions of such values can be get with GetDeferred()
+
+Bool_t TJSONPullParser::ReadSkeleton(std::string &text, Long64_t limit)
+{
+   fDeferred.clear();
+   text.clear();
+
+   if (!BeginObject())
+      return kFALSE;
+
+   text.push_back('{');
+
+   std::string name, value;
+   Int_t res;
+   while ((res = NextName(name)) > 0) {
+      Peek();
+      Long64_t pos = Tell();
+      Bool_t overflow = kFALSE;
+      if (!Scan(&value, limit, overflow, nullptr))
+         return kFALSE;
+
+      if (text.length() > 1)
+         text.push_back(',');
+      text.push_back('"');
+      text.append(name);
+      text.append("\":");
+      if (overflow) {
+         fDeferred[name] = pos;
+         text.append("null");
+      } else {
+         text.append(value);
+      }
+   }
+
+   text.push_back('}');
+
+   return res == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns position of member value, which was not included into skeleton, -1 if not found
+
+Long64_t TJSONPullParser::GetDeferred(const char *name) const
+{
+   auto iter = fDeferred.find(name);
+   return iter != fDeferred.end() ? iter->second : -1;
+}
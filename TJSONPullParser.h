@@ -0,0 +1,223 @@
+// Author: agent  16.10.2026
+
+/*************************************************************************
+ * Copyright (C) 1995-2026, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TJSONPullParser
+#define ROOT_TJSONPullParser
+
+#include "RtypesCore.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <type_traits>
+
+class TJSONPullParser {
+
+public:
+   /// Reads len bytes at offset of the source into out, returns kFALSE on failure
+   using Source_t = std::function<Bool_t(Long64_t offset, Long64_t len, std::string &out)>;
+
+   TJSONPullParser(Long64_t length, const Source_t &source, Long64_t chunk = 65536);
+
+   Long64_t Tell() const { return fBufStart + fCur; }
+   void Seek(Long64_t pos);
+
+   Bool_t BeginObject();
+   Int_t NextName(std::string &name);
+   Bool_t SkipValue();
+   Bool_t ReadNumber(Double_t &value);
+   Long64_t ArrayLength(Long64_t pos);
+
+   Bool_t ReadSkeleton(std::string &text, Long64_t limit);
+   Long64_t GetDeferred(const char *name) const;
+
+   template <typename T>
+   Int_t ReadNumbers(T *dst, Long64_t maxlen);
+
+   template <typename T>
+   Bool_t ReadArray(Long64_t pos, T *dst, Int_t len);
+
+private:
+   TJSONPullParser(const TJSONPullParser &) = delete;            // TJSONPullParser cannot be copied
+   TJSONPullParser &operator=(const TJSONPullParser &) = delete; // TJSONPullParser cannot be copied
+
+   Long64_t fLength{0};     ///< total length of the source
+   Source_t fSource;        ///< function to read data
+   Long64_t fChunk{65536};  ///< size of data, read at once
+   std::string fBuf;        ///< currently read data
+   Long64_t fBufStart{0};   ///< position of the buffer in the source
+   Long64_t fCur{0};        ///< current position in the buffer
+   Bool_t fFailed{kFALSE};  ///< reading of the source failed
+   std::map<std::string, Long64_t> fDeferred; ///< positions of large members, not included into skeleton
+
+   Bool_t Ensure(Long64_t n);
+   char Peek();
+   Bool_t Expect(char c);
+   Bool_t Scan(std::string *capture, Long64_t limit, Bool_t &overflow, Long64_t *count);
+
+   template <typename T>
+   Bool_t ReadSparse(T *dst, Int_t len);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read JSON array of numbers directly into destination
+/// Returns number of read values or -1 if value is not an array or has more than maxlen elements
+
+template <typename T>
+Int_t TJSONPullParser::ReadNumbers(T *dst, Long64_t maxlen)
+{
+   if (!Expect('['))
+      return -1;
+
+   Int_t cnt = 0;
+   while (true) {
+      char c = Peek();
+      if (c == ']') {
+         fCur++;
+         return cnt;
+      }
+      if (cnt > 0) {
+         if (c != ',')
+            return -1;
+         fCur++;
+         Peek();
+      }
+      if (cnt >= maxlen)
+         return -1;
+
+      // number is shorter than 64 characters, buffer is always zero-terminated
+      Ensure(64);
+      const char *ptr = fBuf.data() + fCur;
+      char *next = nullptr;
+      if constexpr (std::is_same<T, Float_t>::value)
+         dst[cnt++] = std::strtof(ptr, &next);
+      else
+         dst[cnt++] = (T)std::strtod(ptr, &next);
+      if (next == ptr)
+         return -1;
+      fCur += next - ptr;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read array with exactly len elements, which starts at position pos
+/// Dense JSON array or sparse TBufferJSON "$arr" object are supported
+
+template <typename T>
+Bool_t TJSONPullParser::ReadArray(Long64_t pos, T *dst, Int_t len)
+{
+   Seek(pos);
+
+   char c = Peek();
+   if (c == '[')
+      return ReadNumbers(dst, len) == len;
+   if (c == '{')
+      return ReadSparse(dst, len);
+   return kFALSE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read sparse array: {"$arr":"Float64","len":N,"p":pos,"v":[...],"p1":pos1,"v1":value,"n1":cnt,...}
+/// Members with same suffix describe one run of values, members may appear in any order.
+/// Run without position continues after previous run. Array values are decoded directly
+/// when position of the run is known, otherwise they are read after all other members
+
+template <typename T>
+Bool_t TJSONPullParser::ReadSparse(T *dst, Int_t len)
+{
+   struct Run {
+      Long64_t fPos{-1};      // position in array, -1 if not specified
+      Long64_t fCount{1};     // repeat counter for single value
+      Double_t fValue{0};     // single value
+      Bool_t fSingle{kFALSE}; // run has single value
+      Long64_t fSource{-1};   // position of not yet decoded values array in the source
+      Long64_t fEnd{-1};      // end of decoded values, -1 if not yet decoded
+   };
+
+   std::map<Long64_t, Run> runs;
+
+   std::fill(dst, dst + len, 0);
+
+   if (!BeginObject())
+      return kFALSE;
+
+   std::string name;
+   Double_t value = 0;
+   Int_t res;
+   while ((res = NextName(name)) > 0) {
+      if (name == "len") {
+         if (!ReadNumber(value) || ((Long64_t)value != len))
+            return kFALSE;
+         continue;
+      }
+      if (name.empty() || !strchr("pnv", name[0]) || ((name.length() > 1) && !isdigit(name[1]))) {
+         if (!SkipValue())
+            return kFALSE;
+         continue;
+      }
+
+      auto &run = runs[name.length() > 1 ? std::atoll(name.c_str() + 1) : 0];
+
+      if (name[0] == 'p') {
+         if (!ReadNumber(value) || (value < 0) || (value > len))
+            return kFALSE;
+         run.fPos = (Long64_t)value;
+      } else if (name[0] == 'n') {
+         if (!ReadNumber(value) || (value < 1))
+            return kFALSE;
+         run.fCount = (Long64_t)value;
+      } else if (Peek() != '[') {
+         if (!ReadNumber(run.fValue))
+            return kFALSE;
+         run.fSingle = kTRUE;
+      } else if (run.fPos >= 0) {
+         Int_t cnt = ReadNumbers(dst + run.fPos, len - run.fPos);
+         if (cnt < 0)
+            return kFALSE;
+         run.fEnd = run.fPos + cnt;
+      } else {
+         run.fSource = Tell();
+         if (!SkipValue())
+            return kFALSE;
+      }
+   }
+
+   if (res < 0)
+      return kFALSE;
+
+   Long64_t pos = 0;
+   for (auto &entry : runs) {
+      auto &run = entry.second;
+      if (run.fPos >= 0)
+         pos = run.fPos;
+      if (run.fEnd >= 0) {
+         pos = run.fEnd;
+      } else if (run.fSource >= 0) {
+         Seek(run.fSource);
+         Int_t cnt = ReadNumbers(dst + pos, len - pos);
+         if (cnt < 0)
+            return kFALSE;
+         pos += cnt;
+      } else if (run.fSingle) {
+         if (pos + run.fCount > len)
+            return kFALSE;
+         std::fill(dst + pos, dst + pos + run.fCount, (T)run.fValue);
+         pos += run.fCount;
+      }
+   }
+
+   return kTRUE;
+}
+
+#endif
@@ -0,0 +1,380 @@
+// Author: agent  16.10.2026
+
+/*************************************************************************
+ * Copyright (C) 1995-2026, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//________________________________________________________________________
+//
+// TJSONTape is read-only lazy DOM over JSON text, kept in external buffer
+// (normally mapped file content). Buffer is not copied.
+// Only structure of navigated containers is scanned and stored on the tape,
+// all other parts of the text are just skipped. Values are converted only
+// when requested, strings without escape sequences can be accessed as
+// std::string_view into the buffer.
+//________________________________________________________________________
+
+#include "TJSONTape.h"
+
+#include <cstring>
+#include <cstdlib>
+
+////////////////////////////////////////////////////////////////////////////////
+/// Create tape for JSON text, only root value is identified
+
+TJSONTape::TJSONTape(std::string_view buf)
+{
+   Reset(buf);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Use tape for other JSON text, all values of previous text become invalid
+/// Memory of the tape is reused, therefore repeated reading does not allocate
+
+void TJSONTape::Reset(std::string_view buf)
+{
+   fBuf = buf;
+   fEntries.clear();
+
+   Long64_t pos = SkipSpaces(0);
+   if (pos >= (Long64_t)fBuf.length())
+      return;
+
+   Entry entry;
+   entry.fBegin = pos;
+   entry.fEnd = SkipValue(pos);
+   entry.fType = Classify(pos);
+   fEntries.emplace_back(entry);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Skip white spaces
+
+Long64_t TJSONTape::SkipSpaces(Long64_t pos) const
+{
+   Long64_t size = fBuf.length();
+   while ((pos < size) && ((fBuf[pos] == ' ') || (fBuf[pos] == '\n') || (fBuf[pos] == '\r') || (fBuf[pos] == '\t')))
+      pos++;
+   return pos;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Skip string, pos should point on opening quote
+/// Returns position after closing quote
+
+Long64_t TJSONTape::SkipString(Long64_t pos) const
+{
+   const char *begin = fBuf.data(), *end = begin + fBuf.length();
+   const char *ptr = begin + pos + 1;
+
+   while (ptr < end) {
+      const char *quote = (const char *)memchr(ptr, '"', end - ptr);
+      if (!quote)
+         break;
+      // quote is escaped when preceded by odd number of backslashes
+      const char *back = quote;
+      while ((back > ptr) && (*(back - 1) == '\\'))
+         back--;
+      if (((quote - back) % 2) == 0)
+         return quote - begin + 1;
+      ptr = quote + 1;
+   }
+
+   return fBuf.length();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Skip any value, pos should point on first value character
+/// Returns position after the value
+
+Long64_t TJSONTape::SkipValue(Long64_t pos) const
+{
+   Long64_t size = fBuf.length();
+   if (pos >= size)
+      return size;
+
+   char c = fBuf[pos];
+
+   if (c == '"')
+      return SkipString(pos);
+
+   if ((c == '{') || (c == '[')) {
+      Int_t depth = 0;
+      while (pos < size) {
+         c = fBuf[pos];
+         if (c == '"') {
+            pos = SkipString(pos);
+            continue;
+         }
+         if ((c == '{') || (c == '['))
+            depth++;
+         else if (((c == '}') || (c == ']')) && (--depth == 0))
+            return pos + 1;
+         pos++;
+      }
+      return size;
+   }
+
+   while ((pos < size) && !strchr(",}] \t\r\n", fBuf[pos]))
+      pos++;
+
+   return pos;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Detect type of value by its first character
+
+TJSONTape::EType TJSONTape::Classify(Long64_t pos) const
+{
+   switch (fBuf[pos]) {
+   case '{': return kObject;
+   case '[': return kArray;
+   case '"': return kString;
+   case 'n': return kNull;
+   case 't':
+   case 'f': return kBool;
+   default: return kNumber;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Scan direct children of container and append them to the tape
+/// Children values are only skipped, their content is not scanned
+
+void TJSONTape::Expand(Int_t indx) const
+{
+   if ((fEntries[indx].fFirst >= 0) || ((fEntries[indx].fType != kObject) && (fEntries[indx].fType != kArray)))
+      return;
+
+   Bool_t isobj = fEntries[indx].fType == kObject;
+   char close = isobj ? '}' : ']';
+   Long64_t end = fEntries[indx].fEnd;
+   Long64_t pos = SkipSpaces(fEntries[indx].fBegin + 1);
+
+   Int_t first = fEntries.size(), size = 0;
+
+   while ((pos < end) && (fBuf[pos] != close)) {
+      Entry entry;
+
+      if (isobj) {
+         if (fBuf[pos] != '"')
+            break;
+         Long64_t keyend = SkipString(pos);
+         entry.fKeyBegin = pos + 1;
+         entry.fKeyLength = keyend - pos - 2;
+         pos = SkipSpaces(keyend);
+         if ((pos >= end) || (fBuf[pos] != ':'))
+            break;
+         pos = SkipSpaces(pos + 1);
+      }
+
+      entry.fBegin = pos;
+      entry.fEnd = SkipValue(pos);
+      entry.fType = Classify(pos);
+      fEntries.emplace_back(entry);
+      size++;
+
+      pos = SkipSpaces(entry.fEnd);
+      if ((pos < end) && (fBuf[pos] == ','))
+         pos = SkipSpaces(pos + 1);
+   }
+
+   fEntries[indx].fFirst = first;
+   fEntries[indx].fSize = size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns type of the value
+
+TJSONTape::EType TJSONTape::Value::GetType() const
+{
+   return IsValid() ? fTape->fEntries[fIndex].fType : kInvalid;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns number of object members or array elements
+
+Int_t TJSONTape::Value::GetSize() const
+{
+   if (!IsValid())
+      return 0;
+   fTape->Expand(fIndex);
+   return fTape->fEntries[fIndex].fSize;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns array element or object member value
+
+TJSONTape::Value TJSONTape::Value::At(Int_t n) const
+{
+   if ((n < 0) || (n >= GetSize()))
+      return Value();
+   return Value(fTape, fTape->fEntries[fIndex].fFirst + n);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns object member with specified name
+
+TJSONTape::Value TJSONTape::Value::operator[](const char *name) const
+{
+   if (!name || (GetType() != kObject))
+      return Value();
+
+   Int_t size = GetSize(), len = strlen(name);
+   Int_t first = fTape->fEntries[fIndex].fFirst;
+
+   for (Int_t n = 0; n < size; n++) {
+      auto &entry = fTape->fEntries[first + n];
+      if ((entry.fKeyLength == len) && !fTape->fBuf.compare(entry.fKeyBegin, len, name))
+         return Value(fTape, first + n);
+   }
+
+   return Value();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns nested value, path is '/' separated list of members names or array indexes
+
+TJSONTape::Value TJSONTape::Value::Path(const char *path) const
+{
+   Value res = *this;
+   std::string name;
+
+   while (path && *path && res.IsValid()) {
+      const char *sep = strchr(path, '/');
+      name.assign(path, sep ? sep - path : strlen(path));
+      path = sep ? sep + 1 : nullptr;
+      if (name.empty())
+         continue;
+      if (res.IsArray())
+         res = res.At(std::atoi(name.c_str()));
+      else
+         res = res[name.c_str()];
+   }
+
+   return res;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns member name, if value belongs to object
+
+std::string_view TJSONTape::Value::GetName() const
+{
+   if (!IsValid())
+      return std::string_view();
+   auto &entry = fTape->fEntries[fIndex];
+   return fTape->fBuf.substr(entry.fKeyBegin, entry.fKeyLength);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns JSON text of the value
+
+std::string_view TJSONTape::Value::GetRaw() const
+{
+   if (!IsValid())
+      return std::string_view();
+   auto &entry = fTape->fEntries[fIndex];
+   return fTape->fBuf.substr(entry.fBegin, entry.fEnd - entry.fBegin);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns string content without quotes, escape sequences are not processed
+/// View points directly into the buffer
+
+std::string_view TJSONTape::Value::GetStringView() const
+{
+   if (GetType() != kString)
+      return std::string_view();
+   auto raw = GetRaw();
+   return raw.length() < 2 ? std::string_view() : raw.substr(1, raw.length() - 2);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns string value with processed escape sequences
+
+std::string TJSONTape::Value::GetString() const
+{
+   auto view = GetStringView();
+
+   std::string res;
+   res.reserve(view.length());
+
+   for (std::size_t n = 0; n < view.length(); n++) {
+      char c = view[n];
+      if ((c != '\\') || (n + 1 >= view.length())) {
+         res.push_back(c);
+         continue;
+      }
+      c = view[++n];
+      switch (c) {
+      case 'n': res.push_back('\n'); break;
+      case 't': res.push_back('\t'); break;
+      case 'r': res.push_back('\r'); break;
+      case 'b': res.push_back('\b'); break;
+      case 'f': res.push_back('\f'); break;
+      case 'u': {
+         if (n + 4 >= view.length())
+            break;
+         unsigned code = std::strtoul(std::string(view.substr(n + 1, 4)).c_str(), nullptr, 16);
+         n += 4;
+         // surrogate pair
+         if ((code >= 0xD800) && (code < 0xDC00) && (n + 6 < view.length()) && (view[n + 1] == '\\') && (view[n + 2] == 'u')) {
+            unsigned low = std::strtoul(std::string(view.substr(n + 3, 4)).c_str(), nullptr, 16);
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            n += 6;
+         }
+         if (code < 0x80) {
+            res.push_back(code);
+         } else if (code < 0x800) {
+            res.push_back(0xC0 | (code >> 6));
+            res.push_back(0x80 | (code & 0x3F));
+         } else if (code < 0x10000) {
+            res.push_back(0xE0 | (code >> 12));
+            res.push_back(0x80 | ((code >> 6) & 0x3F));
+            res.push_back(0x80 | (code & 0x3F));
+         } else {
+            res.push_back(0xF0 | (code >> 18));
+            res.push_back(0x80 | ((code >> 12) & 0x3F));
+            res.push_back(0x80 | ((code >> 6) & 0x3F));
+            res.push_back(0x80 | (code & 0x3F));
+         }
+         break;
+      }
+      default: res.push_back(c); // '"', '\\', '/'
+      }
+   }
+
+   return res;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns numeric value, 0 for non-numbers
+
+Double_t TJSONTape::Value::GetDouble() const
+{
+   if (GetType() != kNumber)
+      return 0;
+   return std::strtod(std::string(GetRaw()).c_str(), nullptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns integer value, 0 for non-numbers
+
+Long64_t TJSONTape::Value::GetLong() const
+{
+   if (GetType() != kNumber)
+      return 0;
+   return std::strtoll(std::string(GetRaw()).c_str(), nullptr, 10);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns boolean value
+
+Bool_t TJSONTape::Value::GetBool() const
+{
+   return (GetType() == kBool) && (GetRaw() == "true");
+}
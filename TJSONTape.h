@@ -0,0 +1,83 @@
+// Author: agent  16.10.2026
+
+/*************************************************************************
+ * Copyright (C) 1995-2026, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TJSONTape
+#define ROOT_TJSONTape
+
+#include "RtypesCore.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+class TJSONTape {
+
+public:
+   enum EType { kInvalid, kNull, kBool, kNumber, kString, kObject, kArray };
+
+   class Value {
+      friend class TJSONTape;
+
+      const TJSONTape *fTape{nullptr}; ///< tape with entries
+      Int_t fIndex{-1};                ///< entry index on the tape
+
+      Value(const TJSONTape *tape, Int_t indx) : fTape(tape), fIndex(indx) {}
+
+   public:
+      Value() = default;
+
+      Bool_t IsValid() const { return fTape && (fIndex >= 0); }
+      EType GetType() const;
+      Bool_t IsNull() const { return GetType() == kNull; }
+      Bool_t IsObject() const { return GetType() == kObject; }
+      Bool_t IsArray() const { return GetType() == kArray; }
+
+      Int_t GetSize() const;
+      Value At(Int_t n) const;
+      Value operator[](const char *name) const;
+      Value Path(const char *path) const;
+
+      std::string_view GetName() const;
+      std::string_view GetRaw() const;
+      std::string_view GetStringView() const;
+      std::string GetString() const;
+      Double_t GetDouble() const;
+      Long64_t GetLong() const;
+      Bool_t GetBool() const;
+   };
+
+   TJSONTape(std::string_view buf = std::string_view());
+
+   void Reset(std::string_view buf);
+
+   Value Root() const { return Value(this, fEntries.empty() ? -1 : 0); }
+
+private:
+   struct Entry {
+      Long64_t fBegin{0};     ///< begin of value in the buffer
+      Long64_t fEnd{0};       ///< end of value in the buffer
+      Long64_t fKeyBegin{0};  ///< begin of member name, for object members
+      Int_t fKeyLength{0};    ///< length of member name
+      Int_t fFirst{-1};       ///< first child entry, -1 if container not yet scanned
+      Int_t fSize{0};         ///< number of children
+      EType fType{kInvalid};  ///< value type
+   };
+
+   std::string_view fBuf;               ///< buffer with JSON text, not owned
+   mutable std::vector<Entry> fEntries; ///< tape entries, filled when navigated
+
+   Long64_t SkipSpaces(Long64_t pos) const;
+   Long64_t SkipString(Long64_t pos) const;
+   Long64_t SkipValue(Long64_t pos) const;
+   EType Classify(Long64_t pos) const;
+   void Expand(Int_t indx) const;
+};
+
+#endif
@@ -0,0 +1,446 @@
+// Author: agent  16.10.2026
+
+/*************************************************************************
+ * Copyright (C) 1995-2026, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//________________________________________________________________________
+//
+// TJSONTreeReader provides access to TTree, stored in TJSONFile.
+//
+// TTree is stored in columnar form: every branch is sequence of chunks,
+// one chunk per tree cluster. Chunk contains values of all entries in
+// the cluster, either as JSON array or as packed (little-endian) values
+// encoded in base64. Packed values are compressed when file compression
+// is enabled, see TJSONFile::SetColumnEncoding().
+// Only branches with single leaf of basic type (or fixed-size array of
+// basic type) are supported, trees with other branches are stored with
+// generic streamer and cannot be accessed with the reader.
+//
+// Reader loads only requested branches and only chunks for requested
+// entries, so memory usage is limited by the cluster size:
+//
+//   TJSONFile f("tree.json");
+//   TJSONTreeReader reader(&f, "T");
+//   Float_t px;
+//   reader.SetBranchAddress("px", &px);
+//   for (Long64_t n = 0; n < reader.GetEntries(); n++)
+//      reader.GetEntry(n);
+//
+// Normal f.Get("T") returns memory-resident TTree with all branches.
+//________________________________________________________________________
+
+#include "TJSONTreeReader.h"
+
+#include "TKeyJSON.h"
+#include "TJSONTape.h"
+#include "TDirectory.h"
+#include "TTree.h"
+#include "TBase64.h"
+#include "TString.h"
+#include "TError.h"
+#include "RZip.h"
+
+#include <nlohmann/json.hpp>
+
+#include <cstring>
+#include <cstdlib>
+#include <type_traits>
+
+namespace jsonio {
+
+const char *Columnar = "_columnar";
+
+struct ColumnType {
+   const char *fName; ///< type name
+   char fCode;        ///< leaflist type code
+   Int_t fSize;       ///< size of value
+};
+
+static const ColumnType gColumnTypes[] = {{"Char_t", 'B', 1},    {"UChar_t", 'b', 1},   {"Short_t", 'S', 2},
+                                          {"UShort_t", 's', 2},  {"Int_t", 'I', 4},     {"UInt_t", 'i', 4},
+                                          {"Long64_t", 'L', 8},  {"ULong64_t", 'l', 8}, {"Float_t", 'F', 4},
+                                          {"Double_t", 'D', 8},  {"Bool_t", 'O', 1},    {nullptr, 0, 0}};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns size of column value, 0 for unsupported types
+
+Int_t ColumnTypeSize(const std::string &type)
+{
+   for (const ColumnType *t = gColumnTypes; t->fName; t++)
+      if (type == t->fName)
+         return t->fSize;
+   return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns leaflist type code for column type
+
+char ColumnTypeCode(const std::string &type)
+{
+   for (const ColumnType *t = gColumnTypes; t->fName; t++)
+      if (type == t->fName)
+         return t->fCode;
+   return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Call function with value of column type, used to instantiate typed code
+
+template <typename Func>
+static Bool_t DispatchColumnType(const std::string &type, Func func)
+{
+   if (type == "Char_t") func(Char_t());
+   else if (type == "UChar_t") func(UChar_t());
+   else if (type == "Short_t") func(Short_t());
+   else if (type == "UShort_t") func(UShort_t());
+   else if (type == "Int_t") func(Int_t());
+   else if (type == "UInt_t") func(UInt_t());
+   else if (type == "Long64_t") func(Long64_t());
+   else if (type == "ULong64_t") func(ULong64_t());
+   else if (type == "Float_t") func(Float_t());
+   else if (type == "Double_t") func(Double_t());
+   else if (type == "Bool_t") func(Bool_t());
+   else return kFALSE;
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Compress buffer in blocks, as done for TKey buffers
+/// Returns kFALSE if compression is disabled or does not reduce size
+
+static Bool_t ZipBuffer(const std::vector<char> &src, std::string &out, Int_t compression)
+{
+   const Long64_t kMaxBlock = 0xffffff;
+
+   Int_t level = compression % 100;
+   auto algorithm = (ROOT::RCompressionSetting::EAlgorithm::EValues)(compression / 100);
+
+   if ((level <= 0) || src.empty())
+      return kFALSE;
+
+   Long64_t size = src.size();
+   out.resize(size);
+
+   Long64_t srcpos = 0, outpos = 0;
+   while (srcpos < size) {
+      Int_t nin = size - srcpos < kMaxBlock ? size - srcpos : kMaxBlock;
+      Int_t nout = size - outpos < kMaxBlock ? size - outpos : kMaxBlock;
+      Int_t irep = 0;
+      R__zipMultipleAlgorithm(level, &nin, (char *)src.data() + srcpos, &nout, &out[outpos], &irep, algorithm);
+      if ((irep <= 0) || (irep >= nin))
+         return kFALSE;
+      srcpos += nin;
+      outpos += irep;
+   }
+
+   out.resize(outpos);
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Decompress buffer, produced by ZipBuffer
+
+static Bool_t UnzipBuffer(const char *src, Long64_t srclen, char *tgt, Long64_t tgtlen)
+{
+   Long64_t srcpos = 0, tgtpos = 0;
+
+   while ((srcpos < srclen) && (tgtpos < tgtlen)) {
+      Int_t nin = 0, nbuf = 0, nout = 0;
+      if (R__unzip_header(&nin, (unsigned char *)src + srcpos, &nbuf) != 0)
+         return kFALSE;
+      if ((srcpos + nin > srclen) || (tgtpos + nbuf > tgtlen))
+         return kFALSE;
+      R__unzip(&nin, (unsigned char *)src + srcpos, &nbuf, (unsigned char *)tgt + tgtpos, &nout);
+      if (nout != nbuf)
+         return kFALSE;
+      srcpos += nin;
+      tgtpos += nbuf;
+   }
+
+   return tgtpos == tgtlen;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Store packed column values in chunk node
+/// Values written as JSON array or as base64-coded packed values, optionally compressed
+
+void EncodeColumnChunk(void *chunknode, const std::vector<char> &data, const std::string &type, Int_t encoding,
+                       Int_t compression)
+{
+   auto &chunk = *((nlohmann::json *)chunknode);
+
+   if (encoding == kColumnsJSON) {
+      auto &arr = chunk["data"] = nlohmann::json::array();
+      DispatchColumnType(type, [&](auto dummy) {
+         using T = decltype(dummy);
+         const T *values = (const T *)data.data();
+         std::size_t len = data.size() / sizeof(T);
+         for (std::size_t n = 0; n < len; n++)
+            arr.push_back(values[n]);
+      });
+      return;
+   }
+
+   std::string zipped;
+   if (ZipBuffer(data, zipped, compression)) {
+      chunk["zip"] = data.size();
+      chunk["base64"] = TBase64::Encode(zipped.data(), zipped.length()).Data();
+   } else {
+      chunk["base64"] = TBase64::Encode(data.data(), data.size()).Data();
+   }
+}
+
+} // namespace jsonio
+
+////////////////////////////////////////////////////////////////////////////////
+/// Create reader for the tree, stored in the key
+
+TJSONTreeReader::TJSONTreeReader(TKeyJSON *key)
+{
+   std::string_view view;
+   if (!key || !key->GetObjectView(view, fBuf))
+      return;
+
+   auto tape = std::make_unique<TJSONTape>(view);
+   auto root = tape->Root();
+   if (!root[jsonio::Columnar].IsValid())
+      return;
+
+   fName = root["fName"].GetString();
+   fTitle = root["fTitle"].GetString();
+   fEntries = root["fEntries"].GetLong();
+
+   auto branches = root["branches"];
+   for (Int_t n = 0; n < branches.GetSize(); n++) {
+      auto br = branches.At(n);
+      Column col;
+      col.fName = br["name"].GetString();
+      col.fType = br["type"].GetString();
+      col.fTypeSize = jsonio::ColumnTypeSize(col.fType);
+      col.fLen = br["len"].GetLong();
+      col.fIndex = n;
+      if ((col.fTypeSize > 0) && (col.fLen > 0))
+         fColumns.emplace_back(std::move(col));
+   }
+
+   fTape = std::move(tape);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Create reader for the tree with specified name, stored in the directory of TJSONFile
+
+TJSONTreeReader::TJSONTreeReader(TDirectory *dir, const char *name)
+   : TJSONTreeReader(dynamic_cast<TKeyJSON *>(dir ? dir->GetKey(name) : nullptr))
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// destructor
+
+TJSONTreeReader::~TJSONTreeReader()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Set address for values of branch
+/// Memory should be large enough for all values of single entry
+/// Only branches with address are read by GetEntry()
+
+Bool_t TJSONTreeReader::SetBranchAddress(const char *name, void *addr)
+{
+   for (auto &col : fColumns)
+      if (col.fName == name) {
+         col.fAddress = addr;
+         return kTRUE;
+      }
+
+   return kFALSE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Load chunk of column with specified entry
+
+Bool_t TJSONTreeReader::LoadChunk(Column &col, Long64_t entry)
+{
+   auto chunks = fTape->Root()["branches"].At(col.fIndex)["chunks"];
+
+   Int_t lo = 0, hi = chunks.GetSize() - 1;
+   while (lo <= hi) {
+      Int_t mid = (lo + hi) / 2;
+      auto chunk = chunks.At(mid);
+      Long64_t first = chunk["first"].GetLong(), number = chunk["n"].GetLong();
+
+      if (entry < first) {
+         hi = mid - 1;
+      } else if (entry >= first + number) {
+         lo = mid + 1;
+      } else {
+         Long64_t size = number * col.fLen * col.fTypeSize;
+         col.fData.resize(size);
+         col.fFirst = col.fNumber = 0;
+
+         auto data = chunk["data"];
+         if (data.IsArray()) {
+            // parse numbers directly from the text, array is not expanded on the tape
+            auto raw = data.GetRaw();
+            const char *ptr = raw.data() + 1, *end = raw.data() + raw.length() - 1;
+            Long64_t cnt = 0, len = number * col.fLen;
+            jsonio::DispatchColumnType(col.fType, [&](auto dummy) {
+               using T = decltype(dummy);
+               T *values = (T *)col.fData.data();
+               while ((ptr < end) && (cnt < len)) {
+                  while ((ptr < end) && strchr(" ,\t\r\n", *ptr))
+                     ptr++;
+                  if (ptr >= end)
+                     break;
+                  char *next = nullptr;
+                  if (*ptr == 't' || *ptr == 'f') {
+                     values[cnt++] = (*ptr == 't') ? 1 : 0;
+                     next = (char *)ptr + (*ptr == 't' ? 4 : 5);
+                  } else if (std::is_floating_point<T>::value) {
+                     values[cnt++] = std::strtod(ptr, &next);
+                  } else if (std::is_signed<T>::value) {
+                     values[cnt++] = std::strtoll(ptr, &next, 10);
+                  } else {
+                     values[cnt++] = std::strtoull(ptr, &next, 10);
+                  }
+                  if (next == ptr)
+                     break;
+                  ptr = next;
+               }
+            });
+            if (cnt != len)
+               return kFALSE;
+         } else {
+            TString decoded = TBase64::Decode(chunk["base64"].GetString().c_str());
+            if (chunk["zip"].IsValid()) {
+               if ((chunk["zip"].GetLong() != size) || !jsonio::UnzipBuffer(decoded.Data(), decoded.Length(), col.fData.data(), size))
+                  return kFALSE;
+            } else {
+               if (decoded.Length() != size)
+                  return kFALSE;
+               memcpy(col.fData.data(), decoded.Data(), size);
+            }
+         }
+
+         col.fFirst = first;
+         col.fNumber = number;
+         return kTRUE;
+      }
+   }
+
+   return kFALSE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read entry, values are copied to addresses set with SetBranchAddress()
+/// Returns number of bytes copied, -1 in case of error or if entry does not exist
+
+Int_t TJSONTreeReader::GetEntry(Long64_t entry)
+{
+   if (!IsValid() || (entry < 0) || (entry >= fEntries))
+      return -1;
+
+   Int_t nbytes = 0;
+
+   for (auto &col : fColumns) {
+      if (!col.fAddress)
+         continue;
+
+      if (((entry < col.fFirst) || (entry >= col.fFirst + col.fNumber)) && !LoadChunk(col, entry))
+         return -1;
+
+      Int_t size = col.fLen * col.fTypeSize;
+      memcpy(col.fAddress, col.fData.data() + (entry - col.fFirst) * size, size);
+      nbytes += size;
+   }
+
+   return nbytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Create memory-resident TTree with selected branches and entries
+/// branches is comma-separated list of branches names, "*" selects all branches
+/// Addresses, set with SetBranchAddress(), remain unchanged
+/// Returns nullptr if any entry cannot be read
+
+TTree *TJSONTreeReader::ReadTree(const char *branches, Long64_t first, Long64_t nentries)
+{
+   if (!IsValid())
+      return nullptr;
+
+   if (first < 0)
+      first = 0;
+   if ((nentries < 0) || (first + nentries > fEntries))
+      nentries = fEntries > first ? fEntries - first : 0;
+
+   std::string selection = branches ? branches : "*";
+   auto selected = [&selection](const std::string &name) {
+      if (selection.empty() || (selection == "*"))
+         return true;
+      std::size_t pos = 0;
+      while (pos <= selection.length()) {
+         std::size_t sep = selection.find(',', pos);
+         if (sep == std::string::npos)
+            sep = selection.length();
+         std::string item = selection.substr(pos, sep - pos);
+         item.erase(0, item.find_first_not_of(' '));
+         item.erase(item.find_last_not_of(' ') + 1);
+         if (item == name)
+            return true;
+         pos = sep + 1;
+      }
+      return false;
+   };
+
+   TTree *tree = new TTree(fName.c_str(), fTitle.c_str());
+   tree->SetDirectory(nullptr);
+
+   std::vector<std::vector<char>> buffers(fColumns.size());
+
+   // addresses of the user are restored at the end
+   std::vector<void *> addresses(fColumns.size());
+
+   for (std::size_t n = 0; n < fColumns.size(); n++) {
+      auto &col = fColumns[n];
+      addresses[n] = col.fAddress;
+      col.fAddress = nullptr;
+      if (!selected(col.fName))
+         continue;
+      buffers[n].resize(col.fLen * col.fTypeSize);
+      col.fAddress = buffers[n].data();
+      TString leaflist = col.fName.c_str();
+      if (col.fLen > 1)
+         leaflist.Append(TString::Format("[%d]", col.fLen));
+      leaflist.Append('/');
+      leaflist.Append(jsonio::ColumnTypeCode(col.fType));
+      tree->Branch(col.fName.c_str(), col.fAddress, leaflist.Data());
+   }
+
+   Bool_t res = kTRUE;
+   for (Long64_t entry = first; res && (entry < first + nentries); entry++) {
+      if (GetEntry(entry) < 0) {
+         ::Error("TJSONTreeReader::ReadTree", "Fail to read entry %lld of tree %s", entry, fName.c_str());
+         res = kFALSE;
+      } else {
+         tree->Fill();
+      }
+   }
+
+   tree->ResetBranchAddresses();
+
+   for (std::size_t n = 0; n < fColumns.size(); n++)
+      fColumns[n].fAddress = addresses[n];
+
+   if (!res) {
+      delete tree;
+      return nullptr;
+   }
+
+   return tree;
+}
@@ -0,0 +1,84 @@
+// Author: agent  16.10.2026
+
+/*************************************************************************
+ * Copyright (C) 1995-2026, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TJSONTreeReader
+#define ROOT_TJSONTreeReader
+
+#include "RtypesCore.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class TDirectory;
+class TTree;
+class TKeyJSON;
+class TJSONTape;
+
+namespace jsonio {
+extern const char *Columnar;
+
+enum EColumnEncoding { kColumnsJSON = 0, kColumnsBase64 = 1 };
+
+Int_t ColumnTypeSize(const std::string &type);
+char ColumnTypeCode(const std::string &type);
+void EncodeColumnChunk(void *chunknode, const std::vector<char> &data, const std::string &type, Int_t encoding,
+                       Int_t compression);
+}
+
+class TJSONTreeReader {
+
+private:
+   TJSONTreeReader(const TJSONTreeReader &) = delete;            // TJSONTreeReader cannot be copied
+   TJSONTreeReader &operator=(const TJSONTreeReader &) = delete; // TJSONTreeReader cannot be copied
+
+   struct Column {
+      std::string fName;          ///< branch name
+      std::string fType;          ///< type name, like "Float_t"
+      Int_t fTypeSize{0};         ///< size of single value
+      Int_t fLen{1};              ///< number of values per entry
+      Int_t fIndex{-1};           ///< index of branch in stored tree
+      std::vector<char> fData;    ///< values of loaded chunk
+      Long64_t fFirst{0};         ///< first entry of loaded chunk
+      Long64_t fNumber{0};        ///< number of entries in loaded chunk
+      void *fAddress{nullptr};    ///< user address for branch values
+   };
+
+   std::string fBuf;                //! buffer with object text, used when file is not mapped
+   std::unique_ptr<TJSONTape> fTape; //! tape over object text
+   std::string fName;               //! tree name
+   std::string fTitle;              //! tree title
+   Long64_t fEntries{0};            //! number of entries
+   std::vector<Column> fColumns;    //! stored branches
+
+   Bool_t LoadChunk(Column &col, Long64_t entry);
+
+public:
+   TJSONTreeReader(TKeyJSON *key);
+   TJSONTreeReader(TDirectory *dir, const char *name);
+   ~TJSONTreeReader();
+
+   Bool_t IsValid() const { return fTape != nullptr; }
+   const char *GetName() const { return fName.c_str(); }
+   const char *GetTitle() const { return fTitle.c_str(); }
+   Long64_t GetEntries() const { return fEntries; }
+
+   Int_t GetNbranches() const { return fColumns.size(); }
+   const char *GetBranchName(Int_t n) const { return fColumns[n].fName.c_str(); }
+   const char *GetBranchType(Int_t n) const { return fColumns[n].fType.c_str(); }
+   Int_t GetBranchLength(Int_t n) const { return fColumns[n].fLen; }
+
+   Bool_t SetBranchAddress(const char *name, void *addr);
+   Int_t GetEntry(Long64_t entry);
+
+   TTree *ReadTree(const char *branches = "*", Long64_t first = 0, Long64_t nentries = -1);
+};
+
+#endif
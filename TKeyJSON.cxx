@@ -53,6 +53,19 @@ const char *cnt = "cnt";
 const char *True = "true";
 const char *False = "false";
 const char *SInfos = "StreamerInfos";
+const char *SchemaCatalog = "SchemaCatalog";
+const char *SchemaHashes = "SchemaHashes";
+const char *KeysIndex = "KeysIndex";
+const char *IndexSeek = "IndexSeek";
+const char *Delta = "Delta";
+const char *Shared = "Shared";
+const char *SharedObjects = "SharedObjects";
+const char *SharedSubtrees = "SharedSubtrees";
+const char *SharedMark = "$shared";
+const char *ClassDefaults = "ClassDefaults";
+const char *Writer = "writer";
+const char *KeyId = "keyid";
+const char *Deleted = "deleted";
 
 const char *Array = "Array";
 const char *Bool = "Bool_t";
@@ -70,17 +83,104 @@ const char *ULong = "ULong_t";
 const char *ULong64 = "ULong64_t";
 const char *String = "string";
 const char *CharStar = "CharStar";
+
+////////////////////////////////////////////////////////////////////////////////
+/// Fast non-cryptographic 64-bit hash of the buffer
+/// Used to verify content of key records, read on demand from the file
+
+ULong64_t ContentHash(const char *buf, Long64_t len)
+{
+   ContentHasher hasher(len);
+   hasher.Update(buf, len);
+   return hasher.Final();
+}
+
+static constexpr ULong64_t kHashMul = 0x9E3779B97F4A7C15ULL;
+
+////////////////////////////////////////////////////////////////////////////////
+/// Start hashing of content with total length len
+
+ContentHasher::ContentHasher(Long64_t len)
+{
+   fHash = 0x27D4EB2F165667C5ULL ^ ((ULong64_t)len * kHashMul);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Mix next 8-byte word into the hash
+
+void ContentHasher::Mix(const char *buf)
+{
+   ULong64_t w;
+   memcpy(&w, buf, 8);
+   w *= kHashMul;
+   w ^= w >> 29;
+   fHash = ((fHash ^ w) * kHashMul) ^ (fHash >> 31);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Add next piece of content, pieces may have arbitrary length
+
+void ContentHasher::Update(const char *buf, Long64_t len)
+{
+   if (fTailLen > 0) {
+      while ((fTailLen < 8) && (len > 0)) {
+         fTail[fTailLen++] = *buf++;
+         len--;
+      }
+      if (fTailLen < 8)
+         return;
+      Mix(fTail);
+      fTailLen = 0;
+   }
+
+   for (; len >= 8; buf += 8, len -= 8)
+      Mix(buf);
+
+   memcpy(fTail, buf, len);
+   fTailLen = len;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns hash of complete content
+
+ULong64_t ContentHasher::Final() const
+{
+   ULong64_t h = fHash, w = 0;
+   for (Int_t n = 0; n < fTailLen; n++)
+      w |= ((ULong64_t)(unsigned char)fTail[n]) << (8 * n);
+   h ^= w * kHashMul;
+
+   // final avalanche, as in murmur3
+   h ^= h >> 33;
+   h *= 0xFF51AFD7ED558CCDULL;
+   h ^= h >> 33;
+   h *= 0xC4CEB9FE1A85EC53ULL;
+   h ^= h >> 33;
+
+   return h;
+}
+
 };
 
 
 #include "TBufferJSON.h"
 #include "TJSONFile.h"
+#include "TJSONTape.h"
+#include "TJSONPullParser.h"
+#include "TJSONTreeReader.h"
+#include "TJSONCodec.h"
 #include "TClass.h"
+#include "TTree.h"
+#include "TBranch.h"
+#include "TLeaf.h"
+#include "TBufferFile.h"
 #include "TROOT.h"
 #include <nlohmann/json.hpp>
 
 #include <iostream>
 #include <fstream>
+#include <memory>
+#include <optional>
 
 ClassImp(TKeyJSON);
 
@@ -144,6 +244,7 @@ TKeyJSON::TKeyJSON(TDirectory *mother, Long64_t keyid, const void *obj, const TC
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Creates TKeyJSON and takes ownership over json node, from which object can be restored
+/// Node must be allocated individually, it is deleted together with the key
 
 TKeyJSON::TKeyJSON(TDirectory *mother, Long64_t keyid, void *keynode)
    : TKey(mother), fKeyNode(keynode), fKeyId(keyid), fSubdir(kFALSE)
@@ -161,8 +262,82 @@ TKeyJSON::TKeyJSON(TDirectory *mother, Long64_t keyid, void *keynode)
       fDatime = tm;
    }
 
-   fClassName = node[jsonio::Object]["_typename"].get<std::string>().c_str();
+   if (node.contains(jsonio::Object))
+      fClassName = node[jsonio::Object]["_typename"].get<std::string>().c_str();
+   else if (node.contains(jsonio::Delta))
+      fClassName = node[jsonio::Delta][jsonio::ObjClass].get<std::string>().c_str();
+   else if (node.contains(jsonio::Shared))
+      fClassName = node[jsonio::Shared][jsonio::ObjClass].get<std::string>().c_str();
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Creates TKeyJSON for the key record, which is read from the file on demand
+/// Key attributes are taken from the keys index, record itself is read with first access
+
+TKeyJSON::TKeyJSON(TDirectory *mother, Long64_t keyid, const char *name, const char *title, const char *classname,
+                   const char *created, Short_t cycle, Long64_t offset, Long64_t length)
+   : TKey(mother), fKeyNode(nullptr), fKeyId(keyid), fSubdir(kFALSE), fRecordOffset(offset), fRecordLength(length)
+{
+   SetName(name);
+   if (title && *title)
+      SetTitle(title);
+   fCycle = cycle;
+
+   if (created && *created) {
+      TDatime tm(created);
+      fDatime = tm;
+   }
+
+   if (classname)
+      fClassName = classname;
+
+   fNbytes = fObjlen = length < kMaxInt ? (Int_t)length : kMaxInt;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Creates TKeyJSON for object, which was already converted to JSON in other thread
+/// Either payload contains JSON produced by TJSONCodec or objnode points to parsed JSON of object
+/// with objsize length of its text representation, content of both is moved into the key
+
+TKeyJSON::TKeyJSON(TDirectory *mother, Long64_t keyid, const char *name, const char *title, const char *classname,
+                   std::string &payload, void *objnode, Long64_t objsize)
+   : TKey(mother), fKeyNode(nullptr), fKeyId(keyid), fSubdir(kFALSE)
+{
+   SetName(name && *name ? name : (classname ? classname : "Noname"));
+   if (title && *title)
+      SetTitle(title);
+
+   fCycle = GetMotherDir()->AppendKey(this);
+
+   fKeyNode = new nlohmann::json();
+   *((nlohmann::json *) fKeyNode) = nlohmann::json::object();
+
+   fDatime.Set();
+
+   TJSONFile *f = (TJSONFile *)GetFile();
+   if (!f)
+      return;
+
+   StoreKeyAttributes();
+
+   if (classname)
+      fClassName = classname;
+
+   Long64_t size = 0;
+   if (!payload.empty()) {
+      fPayload = std::move(payload);
+      size = fPayload.length();
+   } else if (objnode) {
+      auto &node = *((nlohmann::json *) fKeyNode);
+      node[jsonio::Object] = std::move(*((nlohmann::json *) objnode));
+      size = objsize;
+   }
+
+   if (!StoreShared())
+      StoreDelta();
 
+   f->AddPendingKey(this, size);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -170,11 +345,515 @@ TKeyJSON::TKeyJSON(TDirectory *mother, Long64_t keyid, void *keynode)
 
 TKeyJSON::~TKeyJSON()
 {
+   if (auto f = (TJSONFile *)GetFile()) {
+      if (fKeyNode && (fRecordLength > 0))
+         f->ForgetKeyNode(this);
+      f->RemovePendingKey(this);
+   }
+
    if (fKeyNode) {
       delete ((nlohmann::json *) fKeyNode);
       fKeyNode = nullptr;
    }
 
+   SetSubIndex(nullptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Set index of keys records, stored in the subdirectory record
+/// Copy of index is kept in the key, nullptr just release existing index
+
+void TKeyJSON::SetSubIndex(const void *index)
+{
+   if (fSubIndex) {
+      delete ((nlohmann::json *) fSubIndex);
+      fSubIndex = nullptr;
+   }
+
+   if (index)
+      fSubIndex = new nlohmann::json(*((const nlohmann::json *) index));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Produce JSON text of key record, as written to the file
+/// Object JSON, produced by codec, is inserted as is
+
+void TKeyJSON::WriteRecord(std::string &rec) const
+{
+   rec = ((nlohmann::json *)fKeyNode)->dump();
+
+   if (!fPayload.empty()) {
+      rec.pop_back(); // closing brace, object follows
+      rec.append(",\"");
+      rec.append(jsonio::Object);
+      rec.append("\":");
+      rec.append(fPayload);
+      rec.push_back('}');
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read key record from the file, if it was not done before
+/// Only single record is read and parsed, using offset and length from keys index
+/// If content hash is known, it is verified before parsing
+
+Bool_t TKeyJSON::LoadKeyNode()
+{
+   TJSONFile *f = (TJSONFile *)GetFile();
+
+   std::unique_lock<std::recursive_mutex> lock;
+   if (f)
+      lock = f->LockConcurrent();
+
+   if (fKeyNode) {
+      if (f)
+         f->TouchKeyNode(this);
+      return kTRUE;
+   }
+
+   std::string_view view;
+   std::string buf;
+   if (!GetRecordView(view, buf))
+      return kFALSE;
+
+   try {
+      fKeyNode = new nlohmann::json(nlohmann::json::parse(view));
+   } catch (nlohmann::detail::parse_error const &e) {
+      Error("LoadKeyNode", "Fail to parse record of key %s;%d: %s", GetName(), fCycle, e.what());
+      return kFALSE;
+   }
+
+   // record from spill file is in memory again and can be modified
+   if (fSpillLength > 0) {
+      f->AddPendingKey(this, fSpillLength);
+      fSpillLength = 0;
+   }
+
+   // in memory key always keeps complete object
+   auto &node = *((nlohmann::json *)fKeyNode);
+   if (node.contains(jsonio::Object))
+      f->ExpandObject(&node[jsonio::Object]);
+
+   f->TouchKeyNode(this);
+
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Mark record of the key as written into spill file, key node is released
+
+void TKeyJSON::SetSpilled(Long64_t offset, Long64_t length, ULong64_t hash)
+{
+   if (fKeyNode) {
+      delete ((nlohmann::json *)fKeyNode);
+      fKeyNode = nullptr;
+   }
+   fPayload.clear();
+
+   fSpillOffset = offset;
+   fSpillLength = length;
+   fSpillHash = hash;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Release parsed record of the key, it will be read again from the file when required
+
+void TKeyJSON::UnloadKeyNode()
+{
+   if (auto f = (TJSONFile *)GetFile())
+      f->ForgetKeyNode(this);
+
+   if (fKeyNode && (fRecordLength > 0)) {
+      delete ((nlohmann::json *)fKeyNode);
+      fKeyNode = nullptr;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Provide view on key record in the file, buf used when file is not mapped
+/// If content hash is known, it is verified
+
+Bool_t TKeyJSON::GetRecordView(std::string_view &view, std::string &buf)
+{
+   TJSONFile *f = (TJSONFile *)GetFile();
+
+   if (f && IsSpilled()) {
+      if (!f->ReadSpill(fSpillOffset, fSpillLength, buf))
+         return kFALSE;
+      view = buf;
+      if (jsonio::ContentHash(view.data(), view.length()) != fSpillHash) {
+         Error("GetRecordView", "Content hash mismatch for spilled key %s;%d", GetName(), fCycle);
+         return kFALSE;
+      }
+      return kTRUE;
+   }
+   if (!f || (fRecordLength <= 0))
+      return kFALSE;
+
+   if (!f->GetRecordView(fRecordOffset, fRecordLength, view, buf))
+      return kFALSE;
+
+   if (fRecordHash && (jsonio::ContentHash(view.data(), view.length()) != fRecordHash)) {
+      Error("GetRecordView", "Content hash mismatch for key %s;%d", GetName(), fCycle);
+      return kFALSE;
+   }
+
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns kTRUE if parsed key node should be used to access object
+/// In concurrent-read mode nodes of records from the file can be released or created
+/// by other threads, therefore record is always read from the file
+
+Bool_t TKeyJSON::UseKeyNode() const
+{
+   TJSONFile *f = (TJSONFile *)GetFile();
+   if (f && f->IsConcurrentRead() && (fRecordLength > 0))
+      return kFALSE;
+
+   return fKeyNode != nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Provide view on JSON text of stored object
+/// If key node is loaded, object text is produced in buf
+
+Bool_t TKeyJSON::GetObjectView(std::string_view &view, std::string &buf)
+{
+   if (!fPayload.empty()) {
+      view = fPayload;
+      return kTRUE;
+   }
+
+   Bool_t isdelta = kFALSE;
+
+   if (UseKeyNode()) {
+      auto &node = *((nlohmann::json *)fKeyNode);
+      if (node.contains(jsonio::Object)) {
+         buf = node[jsonio::Object].dump();
+         view = buf;
+         return kTRUE;
+      }
+      if (node.contains(jsonio::Shared))
+         return ((TJSONFile *)GetFile())->GetSharedView(node[jsonio::Shared]["id"].get<Int_t>(), view, buf);
+      isdelta = node.contains(jsonio::Delta);
+   } else {
+      // record in the file is navigated with tape, object text is used as is
+      if (!GetRecordView(view, buf))
+         return kFALSE;
+
+      TJSONTape tape(view);
+      auto objnode = tape.Root()[jsonio::Object];
+      if (objnode.IsValid()) {
+         view = objnode.GetRaw();
+         return ((TJSONFile *)GetFile())->ExpandObject(view, buf);
+      }
+      auto sharednode = tape.Root()[jsonio::Shared]["id"];
+      if (sharednode.GetType() == TJSONTape::kNumber)
+         return ((TJSONFile *)GetFile())->GetSharedView((Int_t)sharednode.GetDouble(), view, buf);
+      isdelta = tape.Root()[jsonio::Delta].IsValid();
+   }
+
+   if (!isdelta)
+      return kFALSE;
+
+   // delta cycle, complete object is reconstructed and kept as base for next cycle
+   auto full = (nlohmann::json *)ReadFullObject();
+   if (!full)
+      return kFALSE;
+
+   buf = full->dump();
+   view = buf;
+
+   ((TJSONFile *)GetFile())->SetDeltaCache(fKeyId, full);
+
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns complete JSON object of the key as new nlohmann::json, caller owns it
+/// For delta cycle, base cycles are reconstructed recursively and patch is applied.
+/// Object, cached in the file for this key, is used when available
+
+void *TKeyJSON::ReadFullObject()
+{
+   TJSONFile *f = (TJSONFile *)GetFile();
+   if (!f)
+      return nullptr;
+
+   auto cached = (nlohmann::json *)f->TakeDeltaCache(fKeyId);
+   if (cached)
+      return cached;
+
+   std::unique_ptr<nlohmann::json> res, delta;
+
+   // shared object of the file, null when object is not found
+   auto ReadSharedObject = [f](Int_t id) -> nlohmann::json {
+      std::string_view view;
+      std::string buf;
+      if (!f->GetSharedView(id, view, buf))
+         return nullptr;
+      return nlohmann::json::parse(view);
+   };
+
+   try {
+      if (!fPayload.empty()) {
+         res = std::make_unique<nlohmann::json>(nlohmann::json::parse(fPayload));
+      } else if (UseKeyNode()) {
+         auto &node = *((nlohmann::json *)fKeyNode);
+         if (node.contains(jsonio::Object))
+            res = std::make_unique<nlohmann::json>(node[jsonio::Object]);
+         else if (node.contains(jsonio::Delta))
+            delta = std::make_unique<nlohmann::json>(node[jsonio::Delta]);
+         else if (node.contains(jsonio::Shared))
+            res = std::make_unique<nlohmann::json>(ReadSharedObject(node[jsonio::Shared]["id"].get<Int_t>()));
+      } else {
+         std::string_view view;
+         std::string buf;
+         if (!GetRecordView(view, buf))
+            return nullptr;
+         TJSONTape tape(view);
+         auto objnode = tape.Root()[jsonio::Object];
+         auto deltanode = tape.Root()[jsonio::Delta];
+         auto sharednode = tape.Root()[jsonio::Shared]["id"];
+         if (objnode.IsValid()) {
+            res = std::make_unique<nlohmann::json>(nlohmann::json::parse(objnode.GetRaw()));
+            f->ExpandObject(res.get());
+         } else if (deltanode.IsValid())
+            delta = std::make_unique<nlohmann::json>(nlohmann::json::parse(deltanode.GetRaw()));
+         else if (sharednode.GetType() == TJSONTape::kNumber)
+            res = std::make_unique<nlohmann::json>(ReadSharedObject((Int_t)sharednode.GetDouble()));
+      }
+
+      if (delta) {
+         Short_t basecycle = (*delta)["base"].get<Short_t>();
+         auto base = dynamic_cast<TKeyJSON *>(GetMotherDir()->GetKey(GetName(), basecycle));
+         if (!base) {
+            Error("ReadFullObject", "Base cycle %d not found for key %s;%d", basecycle, GetName(), fCycle);
+            return nullptr;
+         }
+         res.reset((nlohmann::json *)base->ReadFullObject());
+         if (res)
+            res->patch_inplace((*delta)["patch"]);
+      }
+   } catch (nlohmann::json::exception const &e) {
+      Error("ReadFullObject", "Fail to reconstruct object of key %s;%d: %s", GetName(), fCycle, e.what());
+      return nullptr;
+   }
+
+   return res.release();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Store object of new cycle as patch against previous cycle
+/// Patch is only used when it is smaller than complete object and chain of
+/// delta cycles does not exceed keyframe interval, configured in the file.
+/// Complete object remains cached in the file as base for the next cycle
+
+void TKeyJSON::StoreDelta()
+{
+   TJSONFile *f = (TJSONFile *)GetFile();
+   if (!f || !fKeyNode || (f->GetDeltaCycles() <= 0))
+      return;
+
+   auto &node = *((nlohmann::json *)fKeyNode);
+
+   std::unique_ptr<nlohmann::json> cur;
+   Long64_t fulllen = 0;
+   if (!fPayload.empty()) {
+      cur = std::make_unique<nlohmann::json>(nlohmann::json::parse(fPayload));
+      fulllen = fPayload.length();
+   } else if (node.contains(jsonio::Object)) {
+      cur = std::make_unique<nlohmann::json>(node[jsonio::Object]);
+   } else {
+      return;
+   }
+
+   auto base = (fCycle > 1) ? dynamic_cast<TKeyJSON *>(GetMotherDir()->GetKey(GetName(), fCycle - 1)) : nullptr;
+
+   // depth of base in the delta chain, unknown for records which were not read
+   Int_t depth = -1;
+   if (base && base->fKeyNode && (base->fClassName == fClassName)) {
+      auto &basenode = *((nlohmann::json *)base->fKeyNode);
+      depth = basenode.contains(jsonio::Delta) ? basenode[jsonio::Delta]["depth"].get<Int_t>() : 0;
+   }
+
+   if ((depth >= 0) && (depth + 1 < f->GetDeltaCycles())) {
+      std::unique_ptr<nlohmann::json> full((nlohmann::json *)base->ReadFullObject());
+      if (full) {
+         auto patch = nlohmann::json::diff(*full, *cur);
+         if (fulllen == 0)
+            fulllen = node[jsonio::Object].dump().length();
+         if ((Long64_t)patch.dump().length() < fulllen) {
+            node.erase(jsonio::Object);
+            fPayload.clear();
+            node[jsonio::Delta] = {{jsonio::ObjClass, fClassName.Data()},
+                                   {"base", base->GetCycle()},
+                                   {"depth", depth + 1},
+                                   {"patch", std::move(patch)}};
+            f->fDeltaStored = kTRUE;
+         }
+      }
+   }
+
+   f->SetDeltaCache(fKeyId, cur.release());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Store complete objects in all cycles, which are stored as delta to this key
+/// Called before key object is changed or deleted
+
+void TKeyJSON::DetachDeltaCycles()
+{
+   TJSONFile *f = (TJSONFile *)GetFile();
+   if (!f || !fMotherDir)
+      return;
+
+   TIter iter(fMotherDir->GetListOfKeys());
+   while (auto key = dynamic_cast<TKeyJSON *>(iter())) {
+      if ((key == this) || (key->GetCycle() <= fCycle) || strcmp(key->GetName(), GetName()))
+         continue;
+      if (!key->LoadKeyNode())
+         continue;
+      auto &node = *((nlohmann::json *)key->fKeyNode);
+      if (!node.contains(jsonio::Delta) || (node[jsonio::Delta]["base"].get<Short_t>() != fCycle))
+         continue;
+      std::unique_ptr<nlohmann::json> full((nlohmann::json *)key->ReadFullObject());
+      if (!full)
+         continue;
+      node.erase(jsonio::Delta);
+      node[jsonio::Object] = std::move(*full);
+   }
+
+   f->SetDeltaCache(0, nullptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Register content of just stored object in the file
+/// If identical object was stored already by other key, object is replaced by
+/// reference on shared object. Returns kTRUE if reference was created
+
+Bool_t TKeyJSON::StoreShared()
+{
+   TJSONFile *f = (TJSONFile *)GetFile();
+   if (!f || !fKeyNode || !f->IsDeduplicate())
+      return kFALSE;
+
+   auto &node = *((nlohmann::json *)fKeyNode);
+
+   std::string text;
+   if (!fPayload.empty())
+      text = fPayload;
+   else if (node.contains(jsonio::Object))
+      text = node[jsonio::Object].dump();
+   else
+      return kFALSE;
+
+   fContentHash = jsonio::ContentHash(text.data(), text.length());
+
+   Int_t id = f->ShareObject(this, fContentHash, text);
+   if (id < 0)
+      return kFALSE;
+
+   SetSharedObject(id);
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Replace object of the key by reference on shared object of the file
+
+void TKeyJSON::SetSharedObject(Int_t id)
+{
+   if (IsSpilled())
+      LoadKeyNode();
+
+   if (!fKeyNode)
+      return;
+
+   auto &node = *((nlohmann::json *)fKeyNode);
+   node.erase(jsonio::Object);
+   node.erase(jsonio::Delta);
+   fPayload.clear();
+   node[jsonio::Shared] = {{jsonio::ObjClass, fClassName.Data()}, {"id", id}};
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns id of shared object, referenced by the key, -1 if key has own object
+
+Int_t TKeyJSON::GetSharedId() const
+{
+   if (!fKeyNode)
+      return -1;
+
+   const auto &node = *((const nlohmann::json *)fKeyNode);
+   if (!node.contains(jsonio::Shared))
+      return -1;
+
+   return node[jsonio::Shared]["id"].get<Int_t>();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read single member of stored object without decoding of complete object
+/// Path is '/' separated list of members names, like "fXaxis/fNbins"
+/// For string member value is returned, for all others - JSON text of the member
+
+Bool_t TKeyJSON::ReadMember(const char *path, TString &value)
+{
+   if (UseKeyNode() && fPayload.empty() && ((nlohmann::json *)fKeyNode)->contains(jsonio::Object)) {
+      auto ptr = nlohmann::json::json_pointer(std::string("/") + jsonio::Object + "/" + path);
+      const auto &node = *((const nlohmann::json *)fKeyNode);
+      if (!node.contains(ptr))
+         return kFALSE;
+      const auto &member = node.at(ptr);
+      value = member.is_string() ? member.get<std::string>().c_str() : member.dump().c_str();
+      return kTRUE;
+   }
+
+   std::string_view view;
+   std::string buf;
+   if (!GetObjectView(view, buf))
+      return kFALSE;
+
+   TJSONTape tape(view);
+   auto member = tape.Root().Path(path);
+   if (!member.IsValid())
+      return kFALSE;
+
+   if (member.GetType() == TJSONTape::kString)
+      value = member.GetString().c_str();
+   else
+      value = std::string(member.GetRaw()).c_str();
+
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read single numeric member of stored object without decoding of complete object
+
+Bool_t TKeyJSON::ReadMember(const char *path, Double_t &value)
+{
+   if (UseKeyNode() && fPayload.empty() && ((nlohmann::json *)fKeyNode)->contains(jsonio::Object)) {
+      auto ptr = nlohmann::json::json_pointer(std::string("/") + jsonio::Object + "/" + path);
+      const auto &node = *((const nlohmann::json *)fKeyNode);
+      if (!node.contains(ptr) || !node.at(ptr).is_number())
+         return kFALSE;
+      value = node.at(ptr).get<Double_t>();
+      return kTRUE;
+   }
+
+   std::string_view view;
+   std::string buf;
+   if (!GetObjectView(view, buf))
+      return kFALSE;
+
+   TJSONTape tape(view);
+   auto member = tape.Root().Path(path);
+   if (member.GetType() != TJSONTape::kNumber)
+      return kFALSE;
+
+   value = member.GetDouble();
+   return kTRUE;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -183,10 +862,26 @@ TKeyJSON::~TKeyJSON()
 
 void TKeyJSON::Delete(Option_t * /*option*/)
 {
+   DetachDeltaCycles();
+
+   if (auto f = (TJSONFile *)GetFile()) {
+      if (fContentHash)
+         f->ReleaseContent(this, fContentHash);
+      f->ReleaseCachedObject(fKeyId);
+      f->ForgetKeyNode(this);
+      f->RemovePendingKey(this);
+      // record remains in the file, reader drops it when tombstone is found
+      if (f->IsAppendMode())
+         f->AppendRecord(this, kTRUE);
+   }
+   fSpillLength = 0;
+   fContentHash = 0;
+
    if (fKeyNode) {
       delete ((nlohmann::json *) fKeyNode);
       fKeyNode = nullptr;
    }
+   fPayload.clear();
 
    fMotherDir->GetListOfKeys()->Remove(this);
 }
@@ -222,6 +917,10 @@ void TKeyJSON::StoreObject(const void *obj, const TClass *cl, Bool_t check_tobj)
 {
 
    TJSONFile *f = (TJSONFile *)GetFile();
+   if (IsSpilled())
+      LoadKeyNode();
+   else if (!fKeyNode && f && f->IsAppendMode())
+      fKeyNode = new nlohmann::json(nlohmann::json::object()); // new record replaces already appended
    if (!f || !fKeyNode)
       return;
 
@@ -236,8 +935,45 @@ void TKeyJSON::StoreObject(const void *obj, const TClass *cl, Bool_t check_tobj)
       cl = actual;
    }
 
+   if (fContentHash) {
+      f->ReleaseContent(this, fContentHash);
+      fContentHash = 0;
+   }
+
+   f->ReleaseCachedObject(fKeyId);
+
    StoreKeyAttributes();
 
+   fPayload.clear();
+
+   // tree is written in columnar form, if not possible - with generic streamer
+   if (obj && cl && cl->InheritsFrom(TTree::Class())) {
+      if (StoreTree((TTree *)((TClass *)cl)->DynamicCast(TTree::Class(), (void *)obj))) {
+         fClassName = cl->GetName();
+         f->fColumnarStored = kTRUE;
+         if (!IsSpilled())
+            f->AddPendingKey(this, fPayload.length());
+         return;
+      }
+      fPayload.clear();
+   }
+
+   // specialized codec writes object JSON directly, without building of JSON DOM
+   auto codec = obj ? TJSONCodec::Find(cl) : nullptr;
+   if (codec) {
+      if (StoreStreamed(codec, obj)) {
+         fClassName = cl->GetName();
+         // large record is already written into spill file
+         if (IsSpilled())
+            return;
+         if (!StoreShared())
+            StoreDelta();
+         f->AddPendingKey(this, fPayload.length());
+         return;
+      }
+      fPayload.clear();
+   }
+
    auto json_str = TBufferJSON::ConvertToJSON(obj, cl);
 
    node[jsonio::Object] = nlohmann::json::parse(json_str.Data());
@@ -245,6 +981,217 @@ void TKeyJSON::StoreObject(const void *obj, const TClass *cl, Bool_t check_tobj)
    if (cl)
       fClassName = cl->GetName();
 
+   if (!StoreShared())
+      StoreDelta();
+
+   f->AddPendingKey(this, json_str.Length());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Write object with codec into payload of the key, see StoreStreamed(produce)
+/// Returns kFALSE if object cannot be handled by codec
+
+Bool_t TKeyJSON::StoreStreamed(const TJSONCodec *codec, const void *obj)
+{
+   TJSONFile *f = (TJSONFile *)GetFile();
+   if (f->GetStreamLimit() <= 0)
+      return codec->Write(fPayload, obj);
+
+   return StoreStreamed([codec, obj](const TJSONCodec::Sink_t &sink) {
+      return codec->WriteStream(obj, TJSONFile::kSpillChunkSize, sink);
+   });
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Write object JSON, produced in pieces by produce function, into payload of the key
+/// When its size exceeds stream limit of the file, complete key record is written
+/// directly into spill file: collected part first, all following pieces as soon as
+/// they are produced. Therefore memory usage does not depend on size of the object.
+/// Such key is marked as spilled.
+/// Returns kFALSE if produce function fails, nothing is stored then
+
+Bool_t TKeyJSON::StoreStreamed(const std::function<Bool_t(const TJSONCodec::Sink_t &)> &produce)
+{
+   TJSONFile *f = (TJSONFile *)GetFile();
+   Long64_t limit = f->GetStreamLimit();
+
+   Long64_t offset = -1;
+
+   auto sink = [&](const char *buf, std::size_t len) -> Bool_t {
+      if (offset < 0) {
+         fPayload.append(buf, len);
+         if ((limit <= 0) || ((Long64_t)fPayload.length() <= limit))
+            return kTRUE;
+
+         // object too large to be kept in memory, continue in spill file
+         std::string rec = ((nlohmann::json *)fKeyNode)->dump();
+         rec.pop_back(); // closing brace, object follows
+         rec.append(",\"");
+         rec.append(jsonio::Object);
+         rec.append("\":");
+         if (!f->WriteSpill(rec, offset))
+            return kFALSE;
+         buf = fPayload.data();
+         len = fPayload.length();
+      }
+
+      Bool_t res = f->AppendSpill(buf, len);
+      if (!fPayload.empty())
+         std::string().swap(fPayload);
+      return res;
+   };
+
+   Bool_t res = produce(sink);
+
+   if (offset < 0)
+      return res;
+
+   ULong64_t hash = 0;
+   if (res)
+      res = f->AppendSpill("}", 1);
+   Long64_t length = f->fSpillSize - offset;
+   if (res)
+      res = f->HashSpill(offset, length, hash);
+
+   if (!res) {
+      // incomplete record is discarded, object will be stored by generic code
+      f->TruncateSpill(offset);
+      fPayload.clear();
+      return kFALSE;
+   }
+
+   f->RemovePendingKey(this);
+   SetSpilled(offset, length, hash);
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Store TTree in columnar form, values of each branch are written in chunks,
+/// one chunk per tree cluster. JSON is produced branch after branch and chunk
+/// after chunk and streamed like any other large object, see StoreStreamed(),
+/// therefore only values of single cluster of single branch are kept in memory.
+/// Entries are read into private buffers, branch addresses set by user are
+/// restored afterwards. Only branches with single leaf of basic type are supported.
+/// Returns kFALSE if tree has other branches, such tree should be stored with
+/// generic streamer. Stored tree can be read back with TJSONTreeReader
+
+Bool_t TKeyJSON::StoreTree(TTree *tree)
+{
+   TJSONFile *f = (TJSONFile *)GetFile();
+   if (!f || !fKeyNode || !tree)
+      return kFALSE;
+
+   struct Column {
+      TBranch *fBranch{nullptr};
+      TLeaf *fLeaf{nullptr};
+      std::string fType;
+      Int_t fSize{0};
+   };
+
+   std::vector<Column> columns;
+
+   TIter iter(tree->GetListOfBranches());
+   while (auto br = (TBranch *)iter()) {
+      TLeaf *leaf = br->GetListOfLeaves()->GetEntriesFast() == 1 ? (TLeaf *)br->GetListOfLeaves()->At(0) : nullptr;
+      std::string type = leaf ? leaf->GetTypeName() : "";
+      Int_t typesize = jsonio::ColumnTypeSize(type);
+      if (!leaf || (br->IsA() != TBranch::Class()) || (br->GetListOfBranches()->GetEntriesFast() > 0) ||
+          leaf->GetLeafCount() || leaf->IsA()->InheritsFrom("TLeafC") || (typesize <= 0) || (leaf->GetLen() <= 0)) {
+         Warning("StoreTree", "Branch %s of tree %s cannot be stored in columnar form, use generic streamer",
+                 br->GetName(), tree->GetName());
+         return kFALSE;
+      }
+      Column col;
+      col.fBranch = br;
+      col.fLeaf = leaf;
+      col.fType = type;
+      col.fSize = typesize * leaf->GetLen();
+      columns.emplace_back(std::move(col));
+   }
+
+   Long64_t nentries = tree->GetEntries();
+   Int_t compression = f->GetCompressionSettings();
+   Int_t encoding = f->GetColumnEncoding();
+
+   auto produce = [&](const TJSONCodec::Sink_t &sink) -> Bool_t {
+      std::string out;
+
+      // pieces are collected and given to the sink in large portions
+      auto emit = [&](const std::string &piece, Bool_t flush = kFALSE) -> Bool_t {
+         out.append(piece);
+         if (!flush && (out.length() < TJSONFile::kSpillChunkSize))
+            return kTRUE;
+         Bool_t res = sink(out.data(), out.length());
+         out.clear();
+         return res;
+      };
+
+      nlohmann::json head = nlohmann::json::object();
+      head["_typename"] = "TTree";
+      head[jsonio::Columnar] = 1;
+      head["fName"] = tree->GetName();
+      head["fTitle"] = tree->GetTitle();
+      head["fEntries"] = nentries;
+      std::string text = head.dump();
+      text.pop_back(); // closing brace, branches follow
+      if (!emit(text + ",\"branches\":["))
+         return kFALSE;
+
+      for (std::size_t n = 0; n < columns.size(); n++) {
+         auto &col = columns[n];
+
+         nlohmann::json brnode = {{"name", col.fBranch->GetName()}, {"type", col.fType}, {"len", col.fLeaf->GetLen()}};
+         text = brnode.dump();
+         text.pop_back();
+         if (!emit((n > 0 ? "," : "") + text + ",\"chunks\":["))
+            return kFALSE;
+
+         // values are read into private buffer, user address and branch status restored afterwards
+         std::vector<Long64_t> entrybuf((col.fSize + sizeof(Long64_t) - 1) / sizeof(Long64_t));
+         char *addr = col.fBranch->GetAddress();
+         Bool_t disabled = col.fBranch->TestBit(TBranch::kDoNotProcess);
+         col.fBranch->ResetBit(TBranch::kDoNotProcess);
+         col.fBranch->SetAddress(entrybuf.data());
+
+         Bool_t res = kTRUE;
+         std::vector<char> data;
+         auto clusters = tree->GetClusterIterator(0);
+         Long64_t first;
+         Int_t nchunk = 0;
+         while (res && ((first = clusters()) < nentries)) {
+            Long64_t last = clusters.GetNextEntry();
+            if (last > nentries)
+               last = nentries;
+
+            data.resize((last - first) * col.fSize);
+            for (Long64_t entry = first; res && (entry < last); entry++) {
+               if (col.fBranch->GetEntry(entry) < 0) {
+                  Error("StoreTree", "Fail to read entry %lld of branch %s", entry, col.fBranch->GetName());
+                  res = kFALSE;
+               } else {
+                  memcpy(data.data() + (entry - first) * col.fSize, entrybuf.data(), col.fSize);
+               }
+            }
+
+            if (res) {
+               nlohmann::json chunk = {{"first", first}, {"n", last - first}};
+               jsonio::EncodeColumnChunk(&chunk, data, col.fType, encoding, compression);
+               res = emit((nchunk++ > 0 ? "," : "") + chunk.dump());
+            }
+         }
+
+         col.fBranch->SetAddress(addr);
+         if (disabled)
+            col.fBranch->SetBit(TBranch::kDoNotProcess);
+
+         if (!res || !emit("]}"))
+            return kFALSE;
+      }
+
+      return emit("]}", kTRUE);
+   };
+
+   return StoreStreamed(produce);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -252,14 +1199,20 @@ void TKeyJSON::StoreObject(const void *obj, const TClass *cl, Bool_t check_tobj)
 
 void TKeyJSON::UpdateAttributes()
 {
-
+   // spilled record already contains attributes, it is not parsed back only to rewrite them
    if (!fKeyNode)
       return;
 
-   //xml->FreeAllAttr(fKeyNode);
+   // attributes are changed in place, object of the key remains
+   auto &node = *((nlohmann::json *)fKeyNode);
 
-   StoreKeyAttributes();
+   node[jsonio::Name] = GetName();
+   node[jsonio::Cycle] = fCycle;
 
+   if (strlen(GetTitle()) > 0)
+      node[jsonio::Title] = GetTitle();
+   else
+      node.erase(jsonio::Title);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -283,6 +1236,8 @@ void TKeyJSON::UpdateObject(TObject *obj)
 
    //xml->FreeAllAttr(fKeyNode);
 
+   DetachDeltaCycles();
+
    StoreObject(obj, nullptr, kTRUE);
 
 }
@@ -291,14 +1246,15 @@ void TKeyJSON::UpdateObject(TObject *obj)
 /// To read an object from the file.
 /// The object associated to this key is read from the file into memory.
 /// Before invoking this function, obj has been created via the
-/// default constructor.
+/// default constructor. Reading is done in place only for classes
+/// with codec, see JsonReadInto()
 
 Int_t TKeyJSON::Read(TObject *tobj)
 {
    if (!tobj)
       return 0;
 
-   void *res = JsonReadAny(tobj, nullptr);
+   void *res = JsonReadAny(tobj, tobj->IsA());
 
    return !res ? 0 : 1;
 }
@@ -315,6 +1271,7 @@ TObject *TKeyJSON::ReadObj()
       if (gROOT->GetForceStyle())
          tobj->UseCurrentStyle();
       if (tobj->IsA() == TDirectoryFile::Class()) {
+         auto lock = ((TJSONFile *)GetFile())->LockConcurrent();
          TDirectoryFile *dir = (TDirectoryFile *)tobj;
          dir->SetName(GetName());
          dir->SetTitle(GetTitle());
@@ -342,6 +1299,7 @@ TObject *TKeyJSON::ReadObjWithBuffer(char * /*bufferRead*/)
       if (gROOT->GetForceStyle())
          tobj->UseCurrentStyle();
       if (tobj->IsA() == TDirectoryFile::Class()) {
+         auto lock = ((TJSONFile *)GetFile())->LockConcurrent();
          TDirectoryFile *dir = (TDirectoryFile *)tobj;
          dir->SetName(GetName());
          dir->SetTitle(GetTitle());
@@ -365,6 +1323,7 @@ void *TKeyJSON::ReadObjectAny(const TClass *expectedClass)
    void *res = JsonReadAny(nullptr, expectedClass);
 
    if (res && (expectedClass == TDirectoryFile::Class())) {
+      auto lock = ((TJSONFile *)GetFile())->LockConcurrent();
       TDirectoryFile *dir = (TDirectoryFile *)res;
       dir->SetName(GetName());
       dir->SetTitle(GetTitle());
@@ -379,33 +1338,231 @@ void *TKeyJSON::ReadObjectAny(const TClass *expectedClass)
    return res;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Read object into existing object of class cl, result is returned in obj
+/// Stored object must have exactly same class. Returns obj or nullptr in case of failure
+/// Reading is done in place only for classes with codec, see JsonReadInto()
+
+void *TKeyJSON::ReadObjectAny(void *obj, const TClass *cl)
+{
+   if (!obj || !cl)
+      return nullptr;
+
+   return JsonReadAny(obj, cl);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read object into existing object of class cl
+/// Only classes with codec, see TJSONCodec, are read in place: values are decoded
+/// directly into the object and repeated reading does not allocate memory.
+/// TBufferJSON cannot read into existing object, therefore for all other classes
+/// temporary object is created from JSON and its members are streamed into obj.
+
+void *TKeyJSON::JsonReadInto(void *obj, const TClass *cl)
+{
+   TClass *keycl = TClass::GetClass(fClassName.Data());
+   if (keycl != cl) {
+      Error("JsonReadInto", "Cannot read object of class %s into object of class %s", fClassName.Data(),
+            cl ? cl->GetName() : "<null>");
+      return nullptr;
+   }
+
+   if (fClassName == "TTree") {
+      Error("JsonReadInto", "Reading into existing TTree is not supported");
+      return nullptr;
+   }
+
+   if (ReadStreamed(keycl, obj))
+      return obj;
+
+   std::string_view view;
+   std::string buf;
+   if (!GetObjectView(view, buf))
+      return nullptr;
+
+   auto codec = TJSONCodec::Find(keycl);
+   if (codec && codec->ReadInto(view, obj, keycl))
+      return obj;
+
+   TClass *rescl = nullptr;
+   std::string json_str(view);
+   void *res = TBufferJSON::ConvertFromJSONAny(json_str.c_str(), &rescl);
+   if (!res)
+      return nullptr;
+
+   if (rescl != keycl) {
+      if (rescl)
+         rescl->Destructor(res);
+      return nullptr;
+   }
+
+   // object members are transferred with normal streamer
+   TBufferFile buffer(TBuffer::kWrite);
+   keycl->Streamer(res, buffer);
+   buffer.SetReadMode();
+   buffer.SetBufferOffset(0);
+   keycl->Streamer(obj, buffer);
+
+   keycl->Destructor(res);
+
+   return obj;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read object with codec directly from key record in the file, using pull parser
+/// Used for records larger than stream threshold of the file. Record is read in pieces,
+/// large bins arrays are decoded directly into object memory, therefore complete record
+/// text is never kept in memory. Content hash is calculated while record is read.
+/// If obj is not specified, new object is created.
+/// Returns nullptr if record cannot be read this way
+
+void *TKeyJSON::ReadStreamed(const TClass *cl, void *obj)
+{
+   // members larger than this are not included into skeleton, but decoded directly
+   const Long64_t kSkeletonLimit = 1024 * 1024;
+
+   TJSONFile *f = (TJSONFile *)GetFile();
+   auto codec = cl ? TJSONCodec::Find(cl) : nullptr;
+   Bool_t spilled = IsSpilled();
+   Long64_t length = spilled ? fSpillLength : fRecordLength;
+   if (!f || !codec || !fPayload.empty() || UseKeyNode() || (f->GetStreamThreshold() <= 0) ||
+       (length < f->GetStreamThreshold()))
+      return nullptr;
+
+   Long64_t offset = spilled ? fSpillOffset : fRecordOffset;
+   ULong64_t hash = spilled ? fSpillHash : fRecordHash;
+
+   // content is hashed when it is read first time
+   jsonio::ContentHasher hasher(length);
+   Long64_t hashed = 0;
+
+   auto source = [&](Long64_t pos, Long64_t len, std::string &out) -> Bool_t {
+      if (!(spilled ? f->ReadSpill(offset + pos, len, out) : f->ReadRecord(offset + pos, len, out)))
+         return kFALSE;
+      if ((pos <= hashed) && (pos + len > hashed)) {
+         hasher.Update(out.data() + (hashed - pos), pos + len - hashed);
+         hashed = pos + len;
+      }
+      return kTRUE;
+   };
+
+   TJSONPullParser pull(length, source, TJSONFile::kSpillChunkSize);
+
+   // find object in the record, shared objects and delta cycles are not handled
+   std::string name, skeleton;
+   if (!pull.BeginObject())
+      return nullptr;
+   Int_t res;
+   while ((res = pull.NextName(name)) > 0) {
+      if (name == jsonio::Object)
+         break;
+      if ((name == jsonio::Shared) || (name == jsonio::Delta) || !pull.SkipValue())
+         return nullptr;
+   }
+   if ((res <= 0) || !pull.ReadSkeleton(skeleton, kSkeletonLimit))
+      return nullptr;
+
+   std::string_view view = skeleton;
+   std::string buf;
+   if (!f->ExpandObject(view, buf))
+      return nullptr;
+
+   void *target = obj ? obj : ((TClass *)cl)->New();
+   if (!target)
+      return nullptr;
+
+   Bool_t ok = codec->ReadStream(view, pull, target, cl);
+
+   if (ok && hash) {
+      // rest of the record is read to complete content hash
+      while (ok && (hashed < length))
+         ok = source(hashed, std::min(TJSONFile::kSpillChunkSize, length - hashed), buf);
+      if (ok && (hasher.Final() != hash)) {
+         Error("ReadStreamed", "Content hash mismatch for key %s;%d", GetName(), fCycle);
+         ok = kFALSE;
+      }
+   }
+
+   if (!ok && !obj)
+      ((TClass *)cl)->Destructor(target);
+
+   return ok ? target : nullptr;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// read object from key and cast to expected class
+/// If obj is specified, object is read into it and expectedClass is class of obj
 
 void *TKeyJSON::JsonReadAny(void *obj, const TClass *expectedClass)
 {
    TJSONFile *f = (TJSONFile *)GetFile();
-   if (!fKeyNode || !f)
-      return obj;
+   if (!f)
+      return nullptr;
+
+   // schema of classes, which differ from dictionaries, required before first object is read
+   f->ApplyStreamerInfos(kFALSE);
 
-   std::string json_str = (*((nlohmann::json *)fKeyNode))["Object"].dump();
+   if (obj)
+      return JsonReadInto(obj, expectedClass);
 
-   //(*((nlohmann::json *)fKeyNode))[jsonio::Object] = nlohmann::json::parse(json_str.Data());
+   // file directory is shared by all threads in concurrent-read mode,
+   // created or cloned objects must not be added to it - there is no current directory while reading
+   std::optional<TDirectory::TContext> ctxt;
+   if (f->IsConcurrentRead())
+      ctxt.emplace(nullptr);
 
    TClass *cl = nullptr;
-   // FIXME: need to have TBufferJSON interface that takes a nlohmann::json parameter.
-   void *res = TBufferJSON::ConvertFromJSONAny(json_str.c_str(), &cl);
+   void *res = fSubdir ? nullptr : f->GetCachedObject(fKeyId, cl);
+
+   if (!res && (fClassName == "TTree")) {
+      // tree stored in columnar form
+      TJSONTreeReader reader(this);
+      if (reader.IsValid()) {
+         res = reader.ReadTree();
+         cl = TTree::Class();
+      }
+   }
+
+   // huge record is decoded in pieces, such object is not cached
+   if (!res && !fSubdir) {
+      TClass *keycl = TClass::GetClass(fClassName.Data());
+      if (keycl && (res = ReadStreamed(keycl, nullptr)))
+         cl = keycl;
+   }
+
+   if (!res) {
+      std::string_view view;
+      std::string buf;
+      if (!GetObjectView(view, buf))
+         return nullptr;
+
+      // specialized codec reads object directly from the text
+      TClass *keycl = TClass::GetClass(fClassName.Data());
+      auto codec = TJSONCodec::Find(keycl);
+      if (codec && (res = codec->Read(view, keycl)))
+         cl = keycl;
+
+      if (!res) {
+         std::string json_str(view);
+
+         // FIXME: need to have TBufferJSON interface that takes a nlohmann::json parameter.
+         res = TBufferJSON::ConvertFromJSONAny(json_str.c_str(), &cl);
+      }
+
+      // size of JSON is used as estimation of object size
+      if (res && cl && !fSubdir)
+         f->CacheObject(fKeyId, res, cl, view.length());
+   }
 
    if (!cl || !res)
-      return obj;
+      return nullptr;
 
    Int_t delta = 0;
 
    if (expectedClass) {
       delta = cl->GetBaseClassOffset(expectedClass);
       if (delta < 0) {
-         if (!obj)
-            cl->Destructor(res);
+         cl->Destructor(res);
          return nullptr;
       }
       if (cl->GetState() > TClass::kEmulated && expectedClass->GetState() <= TClass::kEmulated) {
@@ -13,6 +13,10 @@
 
 #include "TKey.h"
 
+#include <functional>
+#include <string>
+#include <string_view>
+
 namespace jsonio {
 extern const char *Root;
 extern const char *Setup;
@@ -46,6 +50,19 @@ extern const char *cnt;
 extern const char *True;
 extern const char *False;
 extern const char *SInfos;
+extern const char *SchemaCatalog;
+extern const char *SchemaHashes;
+extern const char *KeysIndex;
+extern const char *IndexSeek;
+extern const char *Delta;
+extern const char *Shared;
+extern const char *SharedObjects;
+extern const char *SharedSubtrees;
+extern const char *SharedMark;
+extern const char *ClassDefaults;
+extern const char *Writer;
+extern const char *KeyId;
+extern const char *Deleted;
 
 extern const char *Array;
 extern const char *Bool;
@@ -63,13 +80,35 @@ extern const char *ULong;
 extern const char *ULong64;
 extern const char *String;
 extern const char *CharStar;
+
+ULong64_t ContentHash(const char *buf, Long64_t len);
+
+/// Incremental form of ContentHash(), content may be provided in pieces
+/// Total length of content must be known in advance
+class ContentHasher {
+   ULong64_t fHash{0};   ///< current hash value
+   char fTail[8];        ///< bytes of incomplete word
+   Int_t fTailLen{0};    ///< number of bytes in fTail
+
+   void Mix(const char *buf);
+
+public:
+   ContentHasher(Long64_t len);
+   void Update(const char *buf, Long64_t len);
+   ULong64_t Final() const;
+};
 }
 
 
 class TXMLFile;
+class TTree;
+class TJSONCodec;
 
 class TKeyJSON final : public TKey {
 
+   friend class TJSONTreeReader;
+   friend class TJSONFile;
+
 private:
    TKeyJSON(const TKeyJSON &) = delete;            // TKeyJSON objects are not copiable.
    TKeyJSON &operator=(const TKeyJSON &) = delete; // TKeyJSON objects are not copiable.
@@ -83,6 +122,10 @@ public:
    TKeyJSON(TDirectory *mother, Long64_t keyid, const void *obj, const TClass *cl, const char *name,
            const char *title = nullptr);
    TKeyJSON(TDirectory *mother, Long64_t keyid, void *keynode);
+   TKeyJSON(TDirectory *mother, Long64_t keyid, const char *name, const char *title, const char *classname,
+            const char *created, Short_t cycle, Long64_t offset, Long64_t length);
+   TKeyJSON(TDirectory *mother, Long64_t keyid, const char *name, const char *title, const char *classname,
+            std::string &payload, void *objnode, Long64_t objsize);
    virtual ~TKeyJSON();
 
    // redefined TKey Methods
@@ -90,8 +133,8 @@ public:
    void DeleteBuffer() final {}
    void FillBuffer(char *&) final {}
    char *GetBuffer() const final { return nullptr; }
-   Long64_t GetSeekKey() const final { return fKeyNode ? 1024 : 0; }
-   Long64_t GetSeekPdir() const final { return fKeyNode ? 1024 : 0; }
+   Long64_t GetSeekKey() const final { return fRecordOffset > 0 ? fRecordOffset : (fKeyNode ? 1024 : 0); }
+   Long64_t GetSeekPdir() const final { return (fRecordOffset > 0) || fKeyNode ? 1024 : 0; }
    // virtual ULong_t   Hash() const { return 0; }
    void Keep() final {}
    // virtual void      ls(Option_t* ="") const;
@@ -101,6 +144,7 @@ public:
    TObject *ReadObj() final;
    TObject *ReadObjWithBuffer(char *bufferRead) final;
    void *ReadObjectAny(const TClass *expectedClass) final;
+   void *ReadObjectAny(void *obj, const TClass *cl);
 
    void ReadBuffer(char *&) final {}
    Bool_t ReadFile() final { return kTRUE; }
@@ -116,16 +160,53 @@ public:
    void UpdateObject(TObject *obj);
    void UpdateAttributes();
 
+   Bool_t LoadKeyNode();
+   void UnloadKeyNode();
+   Bool_t IsSpilled() const { return !fKeyNode && (fSpillLength > 0); }
+   void SetSpilled(Long64_t offset, Long64_t length, ULong64_t hash);
+   Bool_t ReadMember(const char *path, TString &value);
+   Bool_t ReadMember(const char *path, Double_t &value);
+   Long64_t GetRecordOffset() const { return fRecordOffset; }
+   Long64_t GetRecordLength() const { return fRecordLength; }
+   void SetRecordHash(ULong64_t hash) { fRecordHash = hash; }
+   void *GetSubIndex() const { return fSubIndex; }
+   void SetSubIndex(const void *index);
+   void WriteRecord(std::string &rec) const;
+   const std::string &GetPayload() const { return fPayload; }
+   Int_t GetSharedId() const;
+
 protected:
    Int_t Read(const char *name) final { return TKey::Read(name); }
    void StoreObject(const void *obj, const TClass *cl, Bool_t check_tobj = kFALSE);
    void StoreKeyAttributes();
+   Bool_t StoreTree(TTree *tree);
+   Bool_t StoreStreamed(const TJSONCodec *codec, const void *obj);
+   Bool_t StoreStreamed(const std::function<Bool_t(const std::function<Bool_t(const char *, std::size_t)> &)> &produce);
 
    void *JsonReadAny(void *obj, const TClass *expectedClass);
+   void *JsonReadInto(void *obj, const TClass *cl);
+   void *ReadStreamed(const TClass *cl, void *obj);
+   Bool_t GetRecordView(std::string_view &view, std::string &buf);
+   Bool_t GetObjectView(std::string_view &view, std::string &buf);
+   Bool_t UseKeyNode() const;
+   void *ReadFullObject();
+   void StoreDelta();
+   void DetachDeltaCycles();
+   Bool_t StoreShared();
+   void SetSharedObject(Int_t id);
 
    void *fKeyNode{nullptr};          //! JSON node with stored object
    Long64_t fKeyId{0};               //! unique identifier of key for search methods
    Bool_t fSubdir{kFALSE};           //! indicates that key contains subdirectory
+   Long64_t fRecordOffset{0};        //! offset of key record in the file, 0 if not known
+   Long64_t fRecordLength{0};        //! length of key record in the file
+   ULong64_t fRecordHash{0};         //! content hash of key record, 0 if not known
+   void *fSubIndex{nullptr};         //! index of keys records in subdirectory
+   std::string fPayload;             //! JSON of object produced by TJSONCodec, used instead of "Object" node
+   ULong64_t fContentHash{0};        //! content hash of stored object, 0 if object is not registered in the file
+   Long64_t fSpillOffset{0};         //! offset of record in spill file
+   Long64_t fSpillLength{0};         //! length of record in spill file, 0 if record not spilled
+   ULong64_t fSpillHash{0};          //! content hash of spilled record
 
    ClassDefOverride(TKeyJSON, 0)    // a special TKey for XML files
 };
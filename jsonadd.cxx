@@ -0,0 +1,59 @@
+// Author: agent  16.10.2026
+
+/*************************************************************************
+ * Copyright (C) 1995-2026, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//________________________________________________________________________
+//
+// jsonadd - merge JSON files, analog of hadd
+//
+//   jsonadd [-f] [-j N] target.json source1.json source2.json ...
+//
+//   -f    overwrite existing target file
+//   -j N  number of reading threads, default is number of cores
+//
+// Target with ".root" suffix is written as binary ROOT file.
+// See TJSONFileMerger for details.
+//________________________________________________________________________
+
+#include "TJSONFileMerger.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char **argv)
+{
+   TJSONFileMerger merger;
+
+   const char *target = nullptr;
+   Bool_t force = kFALSE;
+
+   for (int n = 1; n < argc; n++) {
+      if (!strcmp(argv[n], "-f")) {
+         force = kTRUE;
+      } else if (!strncmp(argv[n], "-j", 2)) {
+         const char *arg = argv[n][2] ? argv[n] + 2 : (n + 1 < argc ? argv[++n] : "0");
+         merger.SetNumThreads(std::atoi(arg));
+      } else if (!target) {
+         target = argv[n];
+      } else {
+         merger.AddFile(argv[n]);
+      }
+   }
+
+   if (!target || (merger.GetNumFiles() == 0)) {
+      printf("Usage: jsonadd [-f] [-j N] target.json source1.json source2.json ...\n");
+      return 1;
+   }
+
+   if (!merger.OutputFile(target, force))
+      return 1;
+
+   return merger.Merge() ? 0 : 1;
+}
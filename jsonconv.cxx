@@ -0,0 +1,80 @@
+// Author: agent  16.10.2026
+
+/*************************************************************************
+ * Copyright (C) 1995-2026, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//________________________________________________________________________
+//
+// root2json / json2root - convert binary ROOT file into JSON file and back
+//
+//   root2json [options] source.root target.json
+//   json2root [options] source.json target.root
+//
+//   -f          overwrite existing target file
+//   -j N        number of reading threads, default is number of cores
+//   -c N        compression settings of target file
+//   -e cbor     write JSON document in CBOR encoding, default is text
+//               unknown encoding is reported as error
+//   -i class    convert only objects of specified class, can be repeated
+//   -x class    skip objects of specified class, can be repeated
+//
+// Both tools are built from this source, direction is defined by file names.
+// Cycles of source keys are renumbered by the target file, gaps are not kept.
+// See TJSONConverter for details.
+//________________________________________________________________________
+
+#include "TJSONConverter.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char **argv)
+{
+   TJSONConverter conv;
+
+   const char *src = nullptr, *dst = nullptr;
+
+   for (int n = 1; n < argc; n++) {
+      const char *arg = argv[n];
+      if (!strcmp(arg, "-f")) {
+         conv.SetForce();
+         continue;
+      }
+      if ((arg[0] == '-') && arg[1] && strchr("jceix", arg[1])) {
+         const char *value = arg[2] ? arg + 2 : (n + 1 < argc ? argv[++n] : "");
+         switch (arg[1]) {
+         case 'j': conv.SetNumThreads(std::atoi(value)); break;
+         case 'c': conv.SetCompression(std::atoi(value)); break;
+         case 'e':
+            if (!strcmp(value, "cbor"))
+               conv.SetEncoding(TJSONConverter::kCBOR);
+            else if (!strcmp(value, "text"))
+               conv.SetEncoding(TJSONConverter::kText);
+            else {
+               fprintf(stderr, "%s: unknown encoding '%s', use text or cbor\n", argv[0], value);
+               return 1;
+            }
+            break;
+         case 'i': conv.IncludeClass(value); break;
+         case 'x': conv.ExcludeClass(value); break;
+         }
+      } else if (!src) {
+         src = arg;
+      } else if (!dst) {
+         dst = arg;
+      }
+   }
+
+   if (!src || !dst) {
+      printf("Usage: %s [-f] [-j N] [-c N] [-e text|cbor] [-i class] [-x class] source target\n", argv[0]);
+      return 1;
+   }
+
+   return conv.Convert(src, dst) ? 0 : 1;
+}